@@ -0,0 +1,76 @@
+#pragma once
+#include "core.h"
+#include "timer.h"
+
+// Shared helpers for the benchmarks in this directory. Every bench_*.cpp is its own executable
+// covering one subsystem, `make bench` builds and runs all of them. Timings are the fastest of
+// several runs, which is the least noisy number for code that doesn't depend on machine load.
+
+// Benchmarks are split into named sections. Without arguments all of them run, otherwise only
+// the ones named on the command line, e.g. `bench/build/bench_memory huge_pages`.
+static inline bool bench_enabled(int argc, char** argv, char const* section)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], section) == 0)
+        {
+            return true;
+        }
+    }
+    return argc <= 1;
+}
+
+// Keeps the compiler from optimizing away work whose result is otherwise unused.
+template <typename T>
+static inline void bench_keep(T const& value)
+{
+    __asm__ __volatile__("" : : "m"(value) : "memory");
+}
+
+// Returns the fastest of `runs` calls to fn in seconds.
+template <typename Fn>
+static f64 bench_best_of(s32 runs, Fn&& fn)
+{
+    Timer timer = make_timer();
+    f64 best = 1e30;
+    for (s32 i = 0; i < runs; ++i)
+    {
+        tick(&timer);
+        fn();
+        f64 elapsed = tick_s(&timer);
+        best = (elapsed < best) ? elapsed : best;
+    }
+    return best;
+}
+
+static inline void bench_section(char const* title)
+{
+    printf("\n%s\n", title);
+}
+
+// One line per measurement: total time plus time per item.
+static inline void bench_report_ns(char const* label, f64 seconds, s64 num_items)
+{
+    printf("  %-52s %10.3f ms %10.2f ns/item\n", label, seconds * 1e3, seconds * 1e9 / f64(num_items));
+}
+
+// One line per measurement: total time plus throughput.
+static inline void bench_report_bytes(char const* label, f64 seconds, u64 num_bytes)
+{
+    printf("  %-52s %10.3f ms %10.2f GiB/s\n", label, seconds * 1e3, f64(num_bytes) / seconds / (1024.0 * 1024.0 * 1024.0));
+}
+
+// splitmix64, deterministic input data without pulling in <random>.
+static inline u64 bench_random(u64* state)
+{
+    u64 z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [lo, hi).
+static inline f32 bench_random_f32(u64* state, f32 lo, f32 hi)
+{
+    return lo + (hi - lo) * f32(bench_random(state) >> 40) * (1.0f / f32(1 << 24));
+}
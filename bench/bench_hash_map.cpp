@@ -0,0 +1,234 @@
+#include "bench.h"
+#include "hash_map.h"
+#include "memory.h"
+#include <unordered_map>
+
+// Hash_Map against std::unordered_map with u64 keys and values, both heap backed. Keys are
+// random, lookups visit them in a different random order than they were inserted in, so
+// large maps miss the cache the way real lookups by path or state hash would.
+
+struct Bench_Keys
+{
+    u64* inserted = nullptr;
+    u64* lookups = nullptr; // inserted, shuffled.
+    u64* missing = nullptr; // Never inserted.
+    s64 count = 0;
+};
+
+static Bench_Keys make_keys(Arena* arena, s64 count)
+{
+    Bench_Keys keys;
+    keys.count = count;
+    keys.inserted = (u64*)arena_push_no_zero_a(arena, sizeof(u64) * count, alignof(u64));
+    keys.lookups = (u64*)arena_push_no_zero_a(arena, sizeof(u64) * count, alignof(u64));
+    keys.missing = (u64*)arena_push_no_zero_a(arena, sizeof(u64) * count, alignof(u64));
+
+    // splitmix64 is a bijection of its counter, so neither stream repeats a key.
+    u64 inserted_state = 1;
+    u64 missing_state = 1ull << 63;
+    for (s64 i = 0; i < count; ++i)
+    {
+        keys.inserted[i] = bench_random(&inserted_state);
+        keys.lookups[i] = keys.inserted[i];
+        keys.missing[i] = bench_random(&missing_state);
+    }
+
+    u64 shuffle_state = 7;
+    for (s64 i = count - 1; i > 0; --i)
+    {
+        s64 j = s64(bench_random(&shuffle_state) % u64(i + 1));
+        u64 tmp = keys.lookups[i];
+        keys.lookups[i] = keys.lookups[j];
+        keys.lookups[j] = tmp;
+    }
+    return keys;
+}
+
+static void bench_size(s64 count)
+{
+    // Small maps are rebuilt and searched several times per run, so every run does a few million operations.
+    s64 const repeats = (count < 4'000'000) ? (4'000'000 + count - 1) / count : 1;
+    s32 const runs = (count < 4'000'000) ? 5 : 1;
+    s64 const num_ops = count * repeats;
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+    Bench_Keys keys = make_keys(&arena, count);
+
+    char title[64];
+    snprintf(title, sizeof(title), "Hash map, %lld u64 keys", count);
+    bench_section(title);
+
+    f64 t = bench_best_of(runs, [&] {
+        for (s64 r = 0; r < repeats; ++r)
+        {
+            Hash_Map<u64, u64> map = hash_map_create<u64, u64>(nullptr);
+            for (s64 i = 0; i < count; ++i)
+            {
+                hash_map_insert(&map, keys.inserted[i], u64(i));
+            }
+            bench_keep(map.count);
+            hash_map_destroy(&map);
+        }
+    });
+    bench_report_ns("Hash_Map insert, growing", t, num_ops);
+
+    t = bench_best_of(runs, [&] {
+        for (s64 r = 0; r < repeats; ++r)
+        {
+            std::unordered_map<u64, u64> map;
+            for (s64 i = 0; i < count; ++i)
+            {
+                map[keys.inserted[i]] = u64(i);
+            }
+            bench_keep(map.size());
+        }
+    });
+    bench_report_ns("std::unordered_map insert, growing", t, num_ops);
+
+    t = bench_best_of(runs, [&] {
+        for (s64 r = 0; r < repeats; ++r)
+        {
+            Hash_Map<u64, u64> map = hash_map_create<u64, u64>(nullptr, count);
+            for (s64 i = 0; i < count; ++i)
+            {
+                hash_map_insert(&map, keys.inserted[i], u64(i));
+            }
+            bench_keep(map.count);
+            hash_map_destroy(&map);
+        }
+    });
+    bench_report_ns("Hash_Map insert, presized", t, num_ops);
+
+    t = bench_best_of(runs, [&] {
+        for (s64 r = 0; r < repeats; ++r)
+        {
+            std::unordered_map<u64, u64> map;
+            map.reserve(size_t(count));
+            for (s64 i = 0; i < count; ++i)
+            {
+                map[keys.inserted[i]] = u64(i);
+            }
+            bench_keep(map.size());
+        }
+    });
+    bench_report_ns("std::unordered_map insert, reserved", t, num_ops);
+
+    // Lookups run on one map of each kind.
+    {
+        Hash_Map<u64, u64> map = hash_map_create<u64, u64>(nullptr);
+        DEFER { hash_map_destroy(&map); };
+        for (s64 i = 0; i < count; ++i)
+        {
+            hash_map_insert(&map, keys.inserted[i], u64(i));
+        }
+
+        t = bench_best_of(runs, [&] {
+            u64 sum = 0;
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                for (s64 i = 0; i < count; ++i)
+                {
+                    sum += *hash_map_find(&map, keys.lookups[i]);
+                }
+            }
+            bench_keep(sum);
+        });
+        bench_report_ns("Hash_Map find, hit", t, num_ops);
+
+        t = bench_best_of(runs, [&] {
+            s64 found = 0;
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                for (s64 i = 0; i < count; ++i)
+                {
+                    found += hash_map_find(&map, keys.missing[i]) ? 1 : 0;
+                }
+            }
+            bench_keep(found);
+        });
+        bench_report_ns("Hash_Map find, miss", t, num_ops);
+    }
+
+    {
+        std::unordered_map<u64, u64> map;
+        for (s64 i = 0; i < count; ++i)
+        {
+            map[keys.inserted[i]] = u64(i);
+        }
+
+        t = bench_best_of(runs, [&] {
+            u64 sum = 0;
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                for (s64 i = 0; i < count; ++i)
+                {
+                    sum += map.find(keys.lookups[i])->second;
+                }
+            }
+            bench_keep(sum);
+        });
+        bench_report_ns("std::unordered_map find, hit", t, num_ops);
+
+        t = bench_best_of(runs, [&] {
+            s64 found = 0;
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                for (s64 i = 0; i < count; ++i)
+                {
+                    found += (map.find(keys.missing[i]) != map.end()) ? 1 : 0;
+                }
+            }
+            bench_keep(found);
+        });
+        bench_report_ns("std::unordered_map find, miss", t, num_ops);
+    }
+
+    // Removing every key, in lookup order. The maps are rebuilt outside of the timed part.
+    {
+        Timer timer = make_timer();
+        f64 best_map = 1e30;
+        f64 best_std = 1e30;
+        for (s32 run = 0; run < runs; ++run)
+        {
+            Hash_Map<u64, u64> map = hash_map_create<u64, u64>(nullptr, count);
+            std::unordered_map<u64, u64> std_map;
+            std_map.reserve(size_t(count));
+            for (s64 i = 0; i < count; ++i)
+            {
+                hash_map_insert(&map, keys.inserted[i], u64(i));
+                std_map[keys.inserted[i]] = u64(i);
+            }
+
+            tick(&timer);
+            for (s64 i = 0; i < count; ++i)
+            {
+                hash_map_remove(&map, keys.lookups[i]);
+            }
+            f64 elapsed = tick_s(&timer);
+            best_map = (elapsed < best_map) ? elapsed : best_map;
+            bench_keep(map.count);
+
+            tick(&timer);
+            for (s64 i = 0; i < count; ++i)
+            {
+                std_map.erase(keys.lookups[i]);
+            }
+            elapsed = tick_s(&timer);
+            best_std = (elapsed < best_std) ? elapsed : best_std;
+            bench_keep(std_map.size());
+
+            hash_map_destroy(&map);
+        }
+        bench_report_ns("Hash_Map remove", best_map, count);
+        bench_report_ns("std::unordered_map erase", best_std, count);
+    }
+}
+
+int main()
+{
+    bench_size(1'000);
+    bench_size(100'000);
+    bench_size(10'000'000);
+    return 0;
+}
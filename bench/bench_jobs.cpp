@@ -0,0 +1,89 @@
+#include "bench.h"
+#include "hash.h"
+#include "jobs.h"
+#include "memory.h"
+#include "shader_compiler.h"
+
+// The second pass of compile_shaders, with glslang replaced by a fixed amount of CPU work per
+// shader: every request gets a source buffer in its thread's scratch arena and hashes it
+// repeatedly, which takes about as long as compiling a small shader. Shader sizes vary, so
+// the work per request does too. This measures how the shader sized jobs spread over the
+// workers, not glslang itself, which may scale worse through its own locks and allocations.
+
+struct Fake_Compile_Job
+{
+    s64 source_size = 0;
+    s64 base_rounds = 0;
+    u64* out_hashes = nullptr;
+};
+
+static void fake_compile_range(void* user, s64 begin, s64 end)
+{
+    Fake_Compile_Job const* job = (Fake_Compile_Job const*)user;
+    for (s64 i = begin; i < end; ++i)
+    {
+        Scratch scratch = scratch_begin();
+        SCRATCH_DEFER_END(scratch);
+
+        u8* source = (u8*)arena_push_no_zero(scratch.arena, u64(job->source_size));
+        memset(source, int(i), size_t(job->source_size));
+
+        u64 hash = u64(i);
+        s64 rounds = job->base_rounds * (1 + i % 4);
+        for (s64 r = 0; r < rounds; ++r)
+        {
+            hash = hash_bytes(source, u64(job->source_size), hash);
+        }
+        job->out_hashes[i] = hash;
+    }
+}
+
+static void bench_shader_compile_scaling()
+{
+    constexpr s64 source_size = 64 * 1024;
+    constexpr s64 base_rounds = 128;
+    constexpr s32 runs = 5;
+    s64 const shader_counts[] = { 16, 64 };
+
+    Arena arena = arena_allocate(Arena_Params{ .reserve_size = 1024 * 1024 });
+    DEFER { arena_free(&arena); };
+
+    Job_System* all_cores = job_system_create(&arena);
+    s32 max_threads = job_system_worker_count(all_cores) + 1;
+    job_system_destroy(all_cores);
+    arena_clear_to_mark(&arena, Mark{ 0 });
+
+    bench_section("compile_shaders with stubbed out compile work, per shader");
+    for (s64 num_shaders : shader_counts)
+    {
+        Fake_Compile_Job job;
+        job.source_size = source_size;
+        job.base_rounds = base_rounds;
+        job.out_hashes = arena_push_array_with_count<u64>(&arena, num_shaders, num_shaders).array;
+        Mark jobs_mark = arena_mark(&arena);
+
+        f64 single_thread = 0.0;
+        for (s32 num_threads = 1; num_threads <= max_threads; ++num_threads)
+        {
+            Job_System* jobs = job_system_create(&arena, num_threads - 1);
+            f64 t = bench_best_of(runs, [&] {
+                job_parallel_for(jobs, num_shaders, C_SHADER_COMPILE_JOB_SIZE, fake_compile_range, &job);
+                bench_keep(job.out_hashes[0]);
+            });
+            job_system_destroy(jobs);
+            arena_clear_to_mark(&arena, jobs_mark);
+
+            single_thread = (num_threads == 1) ? t : single_thread;
+            char label[64];
+            snprintf(label, sizeof(label), "%3lld shaders, %2d threads, %5.2fx", num_shaders, num_threads, single_thread / t);
+            bench_report_ns(label, t, num_shaders);
+        }
+        arena_clear_to_mark(&arena, Mark{ 0 });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (bench_enabled(argc, argv, "shader_compile")) bench_shader_compile_scaling();
+    return 0;
+}
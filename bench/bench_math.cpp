@@ -0,0 +1,446 @@
+#include "bench.h"
+#include "math_batch.h"
+#include "mathlib.h"
+#include "memory.h"
+
+// The SIMD kernels in mathlib.h against their detail:: scalar references. Which SIMD path is
+// measured depends on the build, e.g. `make bench BENCH_ARCH_FLAGS="-mavx2 -mfma"` for AVX.
+
+static char const* math_simd_path()
+{
+    return MATH_AVX ? "AVX" : MATH_SSE ? "SSE" : MATH_NEON ? "NEON" : "scalar";
+}
+
+// Inputs for count independent operations, 32 byte aligned or deliberately 16 bytes off that,
+// which is as far off as a Mat4 can legally be.
+struct Math_Inputs
+{
+    Mat4* a = nullptr;
+    Mat4* b = nullptr;
+    Mat4* out = nullptr;
+    Vec4* va = nullptr;
+    Vec4* vb = nullptr;
+    Vec4* vout = nullptr;
+    s64 count = 0;
+};
+
+template <typename T>
+static T* push_offset(Arena* arena, s64 count, u64 offset)
+{
+    u8* p = (u8*)arena_push_no_zero_a(arena, sizeof(T) * count + 32, 32);
+    return (T*)(p + offset);
+}
+
+static Math_Inputs make_inputs(Arena* arena, s64 count, u64 offset)
+{
+    Math_Inputs in;
+    in.count = count;
+    in.a = push_offset<Mat4>(arena, count, offset);
+    in.b = push_offset<Mat4>(arena, count, offset);
+    in.out = push_offset<Mat4>(arena, count, offset);
+    in.va = push_offset<Vec4>(arena, count, offset);
+    in.vb = push_offset<Vec4>(arena, count, offset);
+    in.vout = push_offset<Vec4>(arena, count, offset);
+
+    u64 state = 17;
+    for (s64 i = 0; i < count; ++i)
+    {
+        for (int k = 0; k < 16; ++k)
+        {
+            in.a[i].m[k] = bench_random_f32(&state, -2.0f, 2.0f);
+            in.b[i].m[k] = bench_random_f32(&state, -2.0f, 2.0f);
+        }
+        in.va[i] = Vec4{ bench_random_f32(&state, -2.0f, 2.0f), bench_random_f32(&state, -2.0f, 2.0f),
+                         bench_random_f32(&state, -2.0f, 2.0f), bench_random_f32(&state, 0.5f, 2.0f) };
+        in.vb[i] = Vec4{ bench_random_f32(&state, -2.0f, 2.0f), bench_random_f32(&state, -2.0f, 2.0f),
+                         bench_random_f32(&state, -2.0f, 2.0f), bench_random_f32(&state, 0.5f, 2.0f) };
+    }
+    return in;
+}
+
+// Runs fn(i) for every input, repeated until a run does about a million operations.
+template <typename Fn>
+static void bench_ops(char const* label, Math_Inputs const& in, Fn&& fn)
+{
+    constexpr s32 runs = 10;
+    s64 const repeats = (1024 * 1024 + in.count - 1) / in.count;
+    f64 t = bench_best_of(runs, [&] {
+        for (s64 r = 0; r < repeats; ++r)
+        {
+            for (s64 i = 0; i < in.count; ++i)
+            {
+                fn(i);
+            }
+            bench_keep(*in.out);
+            bench_keep(*in.vout);
+        }
+    });
+    bench_report_ns(label, t, in.count * repeats);
+}
+
+static void bench_simd_kernels()
+{
+    // Small enough for all inputs to stay in L2, so this measures the kernels and not memory.
+    constexpr s64 count = 1024;
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+
+    char title[64];
+    snprintf(title, sizeof(title), "Vec4/Mat4 kernels, %s vs scalar", math_simd_path());
+    bench_section(title);
+
+    u64 const offsets[] = { 0, 16 };
+    for (u64 offset : offsets)
+    {
+        Math_Inputs in = make_inputs(&arena, count, offset);
+        printf("  %s\n", offset ? "inputs 16 bytes off 32 byte alignment" : "inputs 32 byte aligned");
+
+        bench_ops("mat4_mul(Mat4, Mat4)", in, [&](s64 i) { in.out[i] = mat4_mul(in.a[i], in.b[i]); });
+        bench_ops("detail::mat4_mul_scalar(Mat4, Mat4)", in, [&](s64 i) { in.out[i] = detail::mat4_mul_scalar(in.a[i], in.b[i]); });
+        bench_ops("mat4_mul(Mat4, Vec4)", in, [&](s64 i) { in.vout[i] = mat4_mul(in.a[i], in.va[i]); });
+        bench_ops("detail::mat4_mul_scalar(Mat4, Vec4)", in, [&](s64 i) { in.vout[i] = detail::mat4_mul_scalar(in.a[i], in.va[i]); });
+        bench_ops("transpose", in, [&](s64 i) { in.out[i] = transpose(in.a[i]); });
+        bench_ops("detail::transpose_scalar", in, [&](s64 i) { in.out[i] = detail::transpose_scalar(in.a[i]); });
+        bench_ops("dot(Vec4, Vec4)", in, [&](s64 i) { in.vout[i].x = dot(in.va[i], in.vb[i]); });
+        bench_ops("detail::dot_scalar", in, [&](s64 i) { in.vout[i].x = detail::dot_scalar(in.va[i], in.vb[i]); });
+        bench_ops("cross(Vec4, Vec4)", in, [&](s64 i) { in.vout[i] = cross(in.va[i], in.vb[i]); });
+        bench_ops("detail::cross_scalar", in, [&](s64 i) { in.vout[i] = detail::cross_scalar(in.va[i], in.vb[i]); });
+        bench_ops("normalized(Vec4)", in, [&](s64 i) { in.vout[i] = normalized(in.va[i]); });
+        bench_ops("detail::normalized_scalar", in, [&](s64 i) { in.vout[i] = detail::normalized_scalar(in.va[i]); });
+
+        arena_clear_to_mark(&arena, Mark{ 0 });
+    }
+}
+
+// view_projection * model for every object, the way the frame loop does it, on one thread.
+// 100k objects stream their matrices from memory, 2k stay in L2 and show the arithmetic.
+static void bench_mvp_batch(s64 count)
+{
+    constexpr s32 runs = 20;
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+
+    f32* trs_data = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count * 10, alignof(f32));
+    TRS_Batch trs;
+    f32 const** components[] = { &trs.pos_x, &trs.pos_y, &trs.pos_z, &trs.rot_x, &trs.rot_y,
+                                 &trs.rot_z, &trs.rot_w, &trs.scale_x, &trs.scale_y, &trs.scale_z };
+    for (s64 k = 0; k < 10; ++k)
+    {
+        *components[k] = trs_data + k * count;
+    }
+    trs.count = count;
+
+    Mat4* models = (Mat4*)arena_push_no_zero_a(&arena, sizeof(Mat4) * count, alignof(Mat4));
+    Mat4* out = (Mat4*)arena_push_no_zero_a(&arena, sizeof(Mat4) * count, alignof(Mat4));
+    Mat4* expected = (Mat4*)arena_push_no_zero_a(&arena, sizeof(Mat4) * count, alignof(Mat4));
+
+    u64 state = 23;
+    for (s64 i = 0; i < count; ++i)
+    {
+        Transform t;
+        t.translation = Vec3{ bench_random_f32(&state, -100.0f, 100.0f), bench_random_f32(&state, -100.0f, 100.0f), bench_random_f32(&state, -100.0f, 100.0f) };
+        t.rotation = quat_from_axis_angle(normalized(Vec3{ bench_random_f32(&state, -1.0f, 1.0f), 1.0f, bench_random_f32(&state, -1.0f, 1.0f) }),
+                                          bench_random_f32(&state, -3.0f, 3.0f));
+        t.scale = Vec3{ bench_random_f32(&state, 0.5f, 2.0f), bench_random_f32(&state, 0.5f, 2.0f), bench_random_f32(&state, 0.5f, 2.0f) };
+        f32 const values[] = { t.translation.x, t.translation.y, t.translation.z, t.rotation.x, t.rotation.y,
+                               t.rotation.z, t.rotation.w, t.scale.x, t.scale.y, t.scale.z };
+        for (s64 k = 0; k < 10; ++k)
+        {
+            trs_data[k * count + i] = values[k];
+        }
+        models[i] = mat4_from_transform(t);
+    }
+    Slice<Mat4> model_slice;
+    model_slice.array = models;
+    model_slice.count = count;
+    Mat4 view_projection = mat4_mul(mat4_perspective(1.2f, 16.0f / 9.0f, 0.1f, 1000.0f), mat4_translate(0.0f, -5.0f, 150.0f));
+
+    char title[64];
+    snprintf(title, sizeof(title), "MVPs for %lld objects, %s, one thread", count, math_simd_path());
+    bench_section(title);
+
+    f64 t = bench_best_of(runs, [&] {
+        for (s64 i = 0; i < count; ++i)
+        {
+            out[i] = detail::mat4_mul_scalar(view_projection, models[i]);
+        }
+        bench_keep(*out);
+    });
+    bench_report_ns("detail::mat4_mul_scalar per object", t, count);
+    for (s64 i = 0; i < count; ++i)
+    {
+        expected[i] = out[i];
+    }
+
+    t = bench_best_of(runs, [&] {
+        for (s64 i = 0; i < count; ++i)
+        {
+            out[i] = mat4_mul(view_projection, models[i]);
+        }
+        bench_keep(*out);
+    });
+    bench_report_ns("mat4_mul per object", t, count);
+
+    t = bench_best_of(runs, [&] {
+        mvp_batch_from_models(view_projection, model_slice, out);
+        bench_keep(*out);
+    });
+    bench_report_ns("mvp_batch_from_models", t, count);
+    for (s64 i = 0; i < count; ++i)
+    {
+        ASSERT(mat4_approx_eq(expected[i], out[i], 1e-5f));
+    }
+
+    t = bench_best_of(runs, [&] {
+        mvp_batch_from_trs(view_projection, trs, out);
+        bench_keep(*out);
+    });
+    bench_report_ns("mvp_batch_from_trs", t, count);
+    for (s64 i = 0; i < count; ++i)
+    {
+        ASSERT(mat4_approx_eq(expected[i], out[i], 1e-4f));
+    }
+}
+
+// Largest deviation of m * inverse from the identity, as a measure of accuracy.
+static f32 max_identity_error(Mat4 const* m, Mat4 const* inverse, s64 count)
+{
+    f32 max_error = 0.0f;
+    for (s64 i = 0; i < count; ++i)
+    {
+        Mat4 product = detail::mat4_mul_scalar(m[i], inverse[i]);
+        for (int k = 0; k < 16; ++k)
+        {
+            f32 identity = (k % 5 == 0) ? 1.0f : 0.0f;
+            max_error = math_max(max_error, math_abs(product.m[k] - identity));
+        }
+    }
+    return max_error;
+}
+
+// The structured inverses against the general ones on the kind of matrix they are meant for.
+static void bench_inverse()
+{
+    constexpr s64 count = 1024;
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+    Math_Inputs in = make_inputs(&arena, count, 0);
+    Mat4* affine = push_offset<Mat4>(&arena, count, 0);
+    Mat4* rigid = push_offset<Mat4>(&arena, count, 0);
+
+    u64 state = 29;
+    for (s64 i = 0; i < count; ++i)
+    {
+        Transform t;
+        t.translation = Vec3{ bench_random_f32(&state, -100.0f, 100.0f), bench_random_f32(&state, -100.0f, 100.0f), bench_random_f32(&state, -100.0f, 100.0f) };
+        t.rotation = quat_from_axis_angle(normalized(Vec3{ bench_random_f32(&state, -1.0f, 1.0f), 1.0f, bench_random_f32(&state, -1.0f, 1.0f) }),
+                                          bench_random_f32(&state, -3.0f, 3.0f));
+        t.scale = Vec3{ 1.0f, 1.0f, 1.0f };
+        rigid[i] = mat4_from_transform(t);
+        t.scale = Vec3{ bench_random_f32(&state, 0.1f, 10.0f), bench_random_f32(&state, 0.1f, 10.0f), bench_random_f32(&state, 0.1f, 10.0f) };
+        affine[i] = mat4_from_transform(t);
+    }
+
+    char title[64];
+    snprintf(title, sizeof(title), "Mat4 inverses, %s", math_simd_path());
+    bench_section(title);
+
+    // Lambdas rather than a table of function pointers, so every inverse is inlined into its loop.
+    auto run = [&](char const* label, Mat4 const* inputs, auto&& inverse) {
+        bench_ops(label, in, [&](s64 i) { in.out[i] = inverse(inputs[i]); });
+        printf("  %-52s %10.2e max |m * inverse - I|\n", "", max_identity_error(inputs, in.out, count));
+    };
+    run("random, mat4_inverse", in.a, [](Mat4 const& m) { return mat4_inverse(m); });
+    run("random, detail::mat4_inverse_scalar", in.a, [](Mat4 const& m) { return detail::mat4_inverse_scalar(m); });
+    run("affine, mat4_inverse_affine", affine, [](Mat4 const& m) { return mat4_inverse_affine(m); });
+    run("affine, mat4_inverse", affine, [](Mat4 const& m) { return mat4_inverse(m); });
+    run("affine, detail::mat4_inverse_scalar", affine, [](Mat4 const& m) { return detail::mat4_inverse_scalar(m); });
+    run("rigid, mat4_inverse_rigid", rigid, [](Mat4 const& m) { return mat4_inverse_rigid(m); });
+    run("rigid, mat4_inverse_affine", rigid, [](Mat4 const& m) { return mat4_inverse_affine(m); });
+    run("rigid, mat4_inverse", rigid, [](Mat4 const& m) { return mat4_inverse(m); });
+    run("rigid, detail::mat4_inverse_scalar", rigid, [](Mat4 const& m) { return detail::mat4_inverse_scalar(m); });
+
+    // Normal matrices, against getting them from a general inverse.
+    bench_ops("affine, mat4_inverse_transpose", in, [&](s64 i) { in.out[i] = mat4_inverse_transpose(affine[i]); });
+    bench_ops("affine, transpose(mat4_inverse)", in, [&](s64 i) { in.out[i] = transpose(mat4_inverse(affine[i])); });
+    bench_ops("affine, transpose(detail::mat4_inverse_scalar)", in, [&](s64 i) { in.out[i] = detail::transpose_scalar(detail::mat4_inverse_scalar(affine[i])); });
+}
+
+// sincos per value, scalar against sincos_batch on one thread, over angles a camera or an
+// animation would see.
+static void bench_sincos()
+{
+    constexpr s64 count = 1024 * 1024;
+    constexpr s32 runs = 10;
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+    f32* x = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    f32* out_sin = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    f32* out_cos = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    u64 state = 31;
+    for (s64 i = 0; i < count; ++i)
+    {
+        x[i] = bench_random_f32(&state, -1000.0f, 1000.0f);
+    }
+
+    char title[64];
+    snprintf(title, sizeof(title), "sincos over %lld values in [-1000, 1000], %s", count, math_simd_path());
+    bench_section(title);
+
+    struct Accuracy_Case
+    {
+        char const* name;
+        Trig_Accuracy accuracy;
+    };
+    Accuracy_Case const cases[] = {
+        { "LIBM", Trig_Accuracy::LIBM },
+        { "HIGH", Trig_Accuracy::HIGH },
+        { "LOW", Trig_Accuracy::LOW },
+    };
+    // Call sites pass the accuracy as a constant, so the scalar loops do too.
+    auto run_scalar = [&](char const* label, auto&& fn) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 i = 0; i < count; ++i)
+            {
+                Sin_Cos sc = fn(x[i]);
+                out_sin[i] = sc.sin;
+                out_cos[i] = sc.cos;
+            }
+            bench_keep(*out_sin);
+        });
+        bench_report_ns(label, t, count);
+    };
+    run_scalar("sincos LIBM", [](f32 v) { return sincos(v, Trig_Accuracy::LIBM); });
+    run_scalar("sincos HIGH", [](f32 v) { return sincos(v, Trig_Accuracy::HIGH); });
+    run_scalar("sincos LOW", [](f32 v) { return sincos(v, Trig_Accuracy::LOW); });
+
+    char label[64];
+    for (Accuracy_Case const& c : cases)
+    {
+        f64 t = bench_best_of(runs, [&] {
+            sincos_batch(x, out_sin, out_cos, count, c.accuracy);
+            bench_keep(*out_sin);
+        });
+        snprintf(label, sizeof(label), "sincos_batch %s", c.name);
+        bench_report_ns(label, t, count);
+    }
+}
+
+// Max absolute error against the f64 result, per bucket of x over the documented range
+// |x| <= 1e4, for plotting. Writes sincos_error.csv next to the executable.
+static void bench_sincos_error(char const* exe_path)
+{
+    constexpr f32 range = 1e4f;
+    constexpr s64 num_buckets = 200;
+    constexpr s64 samples_per_bucket = 20'000;
+    constexpr s64 count = num_buckets * samples_per_bucket;
+    constexpr s32 num_columns = 5;
+    char const* const column_names[num_columns] = { "libm", "high", "low", "high_batch", "low_batch" };
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+    f32* x = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    f32* high_sin = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    f32* high_cos = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    f32* low_sin = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    f32* low_cos = (f32*)arena_push_no_zero_a(&arena, sizeof(f32) * count, 32);
+    f32* errors = (f32*)arena_push_a(&arena, sizeof(f32) * num_buckets * num_columns, alignof(f32));
+
+    // Evenly spaced within each bucket plus a random offset, so no multiple of pi/2 is special.
+    u64 state = 37;
+    f32 const bucket_width = 2.0f * range / f32(num_buckets);
+    for (s64 b = 0; b < num_buckets; ++b)
+    {
+        for (s64 i = 0; i < samples_per_bucket; ++i)
+        {
+            f32 t = (f32(i) + bench_random_f32(&state, 0.0f, 1.0f)) / f32(samples_per_bucket);
+            x[b * samples_per_bucket + i] = -range + bucket_width * (f32(b) + t);
+        }
+    }
+    sincos_batch(x, high_sin, high_cos, count, Trig_Accuracy::HIGH);
+    sincos_batch(x, low_sin, low_cos, count, Trig_Accuracy::LOW);
+
+    for (s64 i = 0; i < count; ++i)
+    {
+        f64 exact_sin = sin(f64(x[i]));
+        f64 exact_cos = cos(f64(x[i]));
+        Sin_Cos const results[num_columns] = {
+            sincos(x[i], Trig_Accuracy::LIBM),
+            sincos(x[i], Trig_Accuracy::HIGH),
+            sincos(x[i], Trig_Accuracy::LOW),
+            Sin_Cos{ high_sin[i], high_cos[i] },
+            Sin_Cos{ low_sin[i], low_cos[i] },
+        };
+        f32* bucket = errors + (i / samples_per_bucket) * num_columns;
+        for (s32 k = 0; k < num_columns; ++k)
+        {
+            f32 error = f32(fmax(fabs(f64(results[k].sin) - exact_sin), fabs(f64(results[k].cos) - exact_cos)));
+            bucket[k] = math_max(bucket[k], error);
+        }
+    }
+
+    bench_section("sincos max absolute error for |x| <= 1e4");
+    f32 max_errors[num_columns] = {};
+    for (s64 b = 0; b < num_buckets; ++b)
+    {
+        for (s32 k = 0; k < num_columns; ++k)
+        {
+            max_errors[k] = math_max(max_errors[k], errors[b * num_columns + k]);
+        }
+    }
+    for (s32 k = 0; k < num_columns; ++k)
+    {
+        printf("  %-52s %10.2e\n", column_names[k], max_errors[k]);
+    }
+
+    char csv_path[512];
+    char const* slash = strrchr(exe_path, '/');
+    int dir_length = slash ? int(slash - exe_path + 1) : 0;
+    snprintf(csv_path, sizeof(csv_path), "%.*ssincos_error.csv", dir_length, exe_path);
+    FILE* csv = fopen(csv_path, "w");
+    if (!csv)
+    {
+        printf("  Failed to write %s\n", csv_path);
+        return;
+    }
+    fprintf(csv, "x_min,x_max");
+    for (s32 k = 0; k < num_columns; ++k)
+    {
+        fprintf(csv, ",%s", column_names[k]);
+    }
+    fprintf(csv, "\n");
+    for (s64 b = 0; b < num_buckets; ++b)
+    {
+        fprintf(csv, "%g,%g", -range + bucket_width * f32(b), -range + bucket_width * f32(b + 1));
+        for (s32 k = 0; k < num_columns; ++k)
+        {
+            fprintf(csv, ",%g", errors[b * num_columns + k]);
+        }
+        fprintf(csv, "\n");
+    }
+    fclose(csv);
+    printf("  per bucket in %s\n", csv_path);
+}
+
+int main(int argc, char** argv)
+{
+    // Timing kernels that give wrong results is pointless, and this is the one optimized build
+    // that gets to run the checks.
+    test_math_runtime();
+    printf("test_math_runtime passed (%s)\n", math_simd_path());
+
+    if (bench_enabled(argc, argv, "simd")) bench_simd_kernels();
+    if (bench_enabled(argc, argv, "mvp"))
+    {
+        bench_mvp_batch(2'048);
+        bench_mvp_batch(100'000);
+    }
+    if (bench_enabled(argc, argv, "inverse")) bench_inverse();
+    if (bench_enabled(argc, argv, "sincos")) bench_sincos();
+    if (bench_enabled(argc, argv, "sincos_error")) bench_sincos_error(argv[0]);
+    return 0;
+}
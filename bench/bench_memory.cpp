@@ -0,0 +1,368 @@
+#include "bench.h"
+#include "jobs.h"
+#include "memory.h"
+#include "platform.h"
+#include "shader_compiler.h"
+#include "str.h"
+
+// Fills an allocation the way a caller that overwrites all of it would (file reads, vertex data, ...).
+static void fill(void* p, u64 num_bytes)
+{
+    memset(p, 0x5A, num_bytes);
+    bench_keep(*(u8*)p);
+}
+
+// Each scope pushes, fills and clears one block, like a temp allocation under ARENA_DEFER_CLEAR.
+// The first run commits the pages, the best of several only sees the writes.
+static void bench_zero_policies()
+{
+    constexpr s32 runs = 20;
+    constexpr s32 scopes = 8;
+    u64 const sizes[] = { 64 * 1024, 16 * 1024 * 1024 };
+
+    bench_section("Arena zero policies, push + fill + clear per scope");
+    for (u64 size : sizes)
+    {
+        u64 total_bytes = size * scopes;
+        char label[64];
+
+        struct Policy_Case
+        {
+            char const* name;
+            Arena_Zero_Policy policy;
+        };
+        Policy_Case const cases[] = {
+            { "ZERO_ON_PUSH", Arena_Zero_Policy::ZERO_ON_PUSH },
+            { "ZERO_ON_CLEAR", Arena_Zero_Policy::ZERO_ON_CLEAR },
+            { "NONE", Arena_Zero_Policy::NONE },
+        };
+
+        // What every scope paid before there were policies: zeroed on push and again on clear.
+        {
+            Arena arena = arena_allocate(Arena_Params{ .reserve_size = size, .zero_policy = Arena_Zero_Policy::ZERO_ON_PUSH });
+            f64 t = bench_best_of(runs, [&] {
+                for (s32 i = 0; i < scopes; ++i)
+                {
+                    void* p = arena_push(&arena, size);
+                    fill(p, size);
+                    memset(p, 0, size);
+                    arena_clear_to_mark(&arena, Mark{ 0 });
+                }
+            });
+            snprintf(label, sizeof(label), "%6llu KiB zero on push and clear (before)", size / 1024);
+            bench_report_bytes(label, t, total_bytes);
+            arena_free(&arena);
+        }
+
+        for (Policy_Case const& c : cases)
+        {
+            Arena arena = arena_allocate(Arena_Params{ .reserve_size = size, .zero_policy = c.policy });
+            f64 t = bench_best_of(runs, [&] {
+                for (s32 i = 0; i < scopes; ++i)
+                {
+                    fill(arena_push(&arena, size), size);
+                    arena_clear_to_mark(&arena, Mark{ 0 });
+                }
+            });
+            snprintf(label, sizeof(label), "%6llu KiB %s", size / 1024, c.name);
+            bench_report_bytes(label, t, total_bytes);
+            arena_free(&arena);
+        }
+
+        {
+            Arena arena = arena_allocate(Arena_Params{ .reserve_size = size, .zero_policy = Arena_Zero_Policy::ZERO_ON_PUSH });
+            f64 t = bench_best_of(runs, [&] {
+                for (s32 i = 0; i < scopes; ++i)
+                {
+                    fill(arena_push_no_zero(&arena, size), size);
+                    arena_clear_to_mark(&arena, Mark{ 0 });
+                }
+            });
+            snprintf(label, sizeof(label), "%6llu KiB arena_push_no_zero", size / 1024);
+            bench_report_bytes(label, t, total_bytes);
+            arena_free(&arena);
+        }
+    }
+}
+
+// load_file as it was before it used arena_push_no_zero_a.
+static Array<u8> load_file_zeroed(String file_path, Arena* arena)
+{
+    File_Handle file = open_file(file_path);
+    DEFER { close_file(file); };
+    Option<u64> file_size = get_file_size(file);
+    Array<u8> data = Array<u8>{ (u8*)arena_push_a(arena, file_size.value + 1, alignof(u64)), s64(file_size.value + 1), 0 };
+    read_file(file, data, file_size.value);
+    data[file_size.value] = '\0';
+    return data;
+}
+
+// Reads a file that sits in the OS file cache, so the copy out of the cache and the zeroing are
+// what's left to measure.
+static void bench_load_file()
+{
+    constexpr s32 runs = 20;
+    u64 const sizes[] = { 64 * 1024, 16 * 1024 * 1024 };
+    String path = STRING_LIT("/tmp/editor_bench_load_file.bin");
+
+    bench_section("load_file from the OS file cache");
+    for (u64 size : sizes)
+    {
+        Arena arena = arena_allocate(Arena_Params{ .reserve_size = 2 * size });
+        {
+            u8* contents = (u8*)arena_push_no_zero(&arena, size);
+            fill(contents, size);
+            File_Handle file = create_file(path);
+            bool written = write_file(file, contents, size);
+            close_file(file);
+            ASSERT_MSG(written, "Failed to write benchmark input %s", path.buffer);
+            arena_clear_to_mark(&arena, Mark{ 0 });
+        }
+
+        char label[64];
+        f64 t = bench_best_of(runs, [&] {
+            bench_keep(load_file_zeroed(path, &arena).array[0]);
+            arena_clear_to_mark(&arena, Mark{ 0 });
+        });
+        snprintf(label, sizeof(label), "%6llu KiB arena_push_a (zeroed)", size / 1024);
+        bench_report_bytes(label, t, size);
+
+        t = bench_best_of(runs, [&] {
+            bench_keep(load_file(path, &arena).array[0]);
+            arena_clear_to_mark(&arena, Mark{ 0 });
+        });
+        snprintf(label, sizeof(label), "%6llu KiB load_file (arena_push_no_zero_a)", size / 1024);
+        bench_report_bytes(label, t, size);
+
+        arena_free(&arena);
+        remove(path.buffer);
+    }
+}
+
+// One 1 GiB arena per backing, touched once and then read at random. Whether the OS actually
+// handed out huge pages shows in the flags the arena ended up with.
+static void bench_huge_pages()
+{
+    constexpr u64 size = 1024ull * 1024 * 1024;
+    constexpr u64 num_values = size / sizeof(u64);
+    constexpr s64 num_reads = 32 * 1024 * 1024;
+    constexpr s32 runs = 3;
+
+    struct Backing_Case
+    {
+        char const* name;
+        Arena_Flags flags;
+    };
+    Backing_Case const cases[] = {
+        { "regular pages", Arena_Flags::NONE },
+        { "TRANSPARENT_HUGE_PAGES", Arena_Flags::TRANSPARENT_HUGE_PAGES },
+        { "EXPLICIT_HUGE_PAGES", Arena_Flags::EXPLICIT_HUGE_PAGES },
+    };
+
+    bench_section("Random access over a 1 GiB arena");
+    for (Backing_Case const& c : cases)
+    {
+        Arena arena = arena_allocate(Arena_Params{ .reserve_size = size, .zero_policy = Arena_Zero_Policy::NONE, .flags = c.flags });
+        printf("  %s, got %s\n", c.name,
+               is_set(arena.flags, Arena_Flags::EXPLICIT_HUGE_PAGES)      ? "explicit huge pages"
+               : is_set(arena.flags, Arena_Flags::TRANSPARENT_HUGE_PAGES) ? "transparent huge pages"
+                                                                          : "regular pages");
+
+        Timer timer = make_timer();
+        u64* values = (u64*)arena_push_no_zero_a(&arena, size, alignof(u64));
+        u64 state = 3;
+        for (u64 i = 0; i < num_values; ++i)
+        {
+            values[i] = bench_random(&state);
+        }
+        bench_report_bytes("first touch (commit + page faults + fill)", tick_s(&timer), size);
+
+        // Independent loads, the CPU can overlap their misses.
+        f64 t = bench_best_of(runs, [&] {
+            u64 sum = 0;
+            u64 idx_state = 5;
+            for (s64 i = 0; i < num_reads; ++i)
+            {
+                sum += values[bench_random(&idx_state) & (num_values - 1)];
+            }
+            bench_keep(sum);
+        });
+        bench_report_ns("random reads", t, num_reads);
+
+        // Every address depends on the previous load, so each miss and page walk is paid in full.
+        t = bench_best_of(runs, [&] {
+            u64 idx = 0;
+            for (s64 i = 0; i < num_reads / 8; ++i)
+            {
+                u64 mixed = values[idx] + u64(i);
+                idx = bench_random(&mixed) & (num_values - 1);
+            }
+            bench_keep(idx);
+        });
+        bench_report_ns("dependent random reads", t, num_reads / 8);
+
+        arena_free(&arena);
+    }
+}
+
+struct Atomic_Push_Job
+{
+    Arena* arena = nullptr;
+    s64 pushes_per_chunk = 0;
+    bool use_thread_blocks = false;
+};
+
+static void atomic_push_range(void* user, s64 begin, s64 end)
+{
+    Atomic_Push_Job const* job = (Atomic_Push_Job const*)user;
+    constexpr u64 push_size = 64;
+    for (s64 chunk = begin; chunk < end; ++chunk)
+    {
+        if (job->use_thread_blocks)
+        {
+            Arena_Thread_Block block = arena_thread_block_create(job->arena);
+            for (s64 i = 0; i < job->pushes_per_chunk; ++i)
+            {
+                bench_keep(arena_thread_block_push(&block, push_size, 16));
+            }
+        }
+        else
+        {
+            for (s64 i = 0; i < job->pushes_per_chunk; ++i)
+            {
+                bench_keep(arena_push_atomic(job->arena, push_size, 16));
+            }
+        }
+    }
+}
+
+// A fixed number of 64 byte pushes split into chunks that all threads pull from, once straight
+// through arena_push_atomic and once through a thread block per chunk. The arena is never
+// written to, so this only measures handing out the ranges.
+static void bench_atomic_push()
+{
+    constexpr s64 num_chunks = 256;
+    constexpr s64 pushes_per_chunk = 64 * 1024;
+    constexpr s64 num_pushes = num_chunks * pushes_per_chunk;
+    constexpr s32 runs = 5;
+
+    // Room for the alignment padding arena_push_atomic claims, thread blocks waste less than that.
+    Arena arena = arena_allocate(Arena_Params{ .reserve_size = u64(num_pushes) * (64 + 16), .zero_policy = Arena_Zero_Policy::NONE });
+    Arena jobs_arena = arena_allocate(Arena_Params{ .reserve_size = 1024 * 1024 });
+    DEFER {
+        arena_free(&arena);
+        arena_free(&jobs_arena);
+    };
+
+    Job_System* all_cores = job_system_create(&jobs_arena);
+    s32 max_threads = job_system_worker_count(all_cores) + 1;
+    job_system_destroy(all_cores);
+
+    bench_section("Concurrent 64 byte pushes into one arena");
+
+    // What a single thread gets without atomics, for reference.
+    f64 t = bench_best_of(runs, [&] {
+        for (s64 i = 0; i < num_pushes; ++i)
+        {
+            bench_keep(arena_push_no_zero_a(&arena, 64, 16));
+        }
+        arena_clear_to_mark(&arena, Mark{ 0 });
+    });
+    bench_report_ns("1 thread, arena_push_no_zero_a", t, num_pushes);
+
+    for (s32 num_threads = 1; num_threads <= max_threads; ++num_threads)
+    {
+        Mark jobs_mark = arena_mark(&jobs_arena);
+        Job_System* jobs = job_system_create(&jobs_arena, num_threads - 1);
+        char label[64];
+
+        bool const modes[] = { false, true };
+        for (bool use_thread_blocks : modes)
+        {
+            Atomic_Push_Job job;
+            job.arena = &arena;
+            job.pushes_per_chunk = pushes_per_chunk;
+            job.use_thread_blocks = use_thread_blocks;
+
+            t = bench_best_of(runs, [&] {
+                job_parallel_for(jobs, num_chunks, 1, atomic_push_range, &job);
+                arena_clear_to_mark(&arena, Mark{ 0 });
+            });
+            snprintf(label, sizeof(label), "%2d threads, %s", num_threads, use_thread_blocks ? "arena_thread_block_push" : "arena_push_atomic");
+            bench_report_ns(label, t, num_pushes);
+        }
+
+        job_system_destroy(jobs);
+        arena_clear_to_mark(&jobs_arena, jobs_mark);
+    }
+}
+
+// A 100 MiB arena captured once, then partly or fully overwritten and restored, like a play
+// mode session that touched some or all of the scene. On macOS vm_copy can share pages instead
+// of copying them, so the restore cost depends on how much was written since the snapshot.
+static void bench_snapshot_restore()
+{
+    constexpr u64 size = 100ull * 1024 * 1024;
+    constexpr s32 runs = 10;
+
+    Arena arena = arena_allocate(Arena_Params{ .reserve_size = size, .zero_policy = Arena_Zero_Policy::NONE });
+    Arena copy_arena = arena_allocate(Arena_Params{ .reserve_size = size, .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER {
+        arena_free(&arena);
+        arena_free(&copy_arena);
+    };
+    fill(arena_push_no_zero(&arena, size), size);
+
+    bench_section("Arena snapshot of 100 MiB");
+
+    f64 t = bench_best_of(runs, [&] {
+        Arena_Snapshot snapshot = arena_snapshot_create(&arena);
+        bench_keep(snapshot.data_size);
+        arena_snapshot_destroy(&snapshot);
+    });
+    bench_report_bytes("arena_snapshot_create", t, size);
+
+    Arena_Snapshot snapshot = arena_snapshot_create(&arena);
+    DEFER { arena_snapshot_destroy(&snapshot); };
+
+    u64 const dirty_sizes[] = { 0, size / 100, size };
+    for (u64 dirty : dirty_sizes)
+    {
+        // Writing the pages is part of the session, only the restore is timed.
+        Timer timer = make_timer();
+        f64 best = 1e30;
+        for (s32 run = 0; run < runs; ++run)
+        {
+            memset(arena.buffer, run, dirty);
+            tick(&timer);
+            bool restored = arena_snapshot_restore(&snapshot);
+            f64 elapsed = tick_s(&timer);
+            ASSERT(restored);
+            best = (elapsed < best) ? elapsed : best;
+        }
+        ASSERT(((u8*)arena.buffer)[0] == 0x5A && ((u8*)arena.buffer)[size - 1] == 0x5A);
+
+        char label[64];
+        snprintf(label, sizeof(label), "arena_snapshot_restore, %3llu MiB written since", dirty / (1024 * 1024));
+        bench_report_bytes(label, best, size);
+    }
+
+    // What a restore costs without any help from the OS.
+    void* copy = arena_push_no_zero(&copy_arena, size);
+    fill(copy, size);
+    t = bench_best_of(runs, [&] {
+        memcpy(arena.buffer, copy, size);
+        bench_keep(*(u8*)arena.buffer);
+    });
+    bench_report_bytes("memcpy of the whole arena", t, size);
+}
+
+int main(int argc, char** argv)
+{
+    if (bench_enabled(argc, argv, "zero_policies")) bench_zero_policies();
+    if (bench_enabled(argc, argv, "load_file")) bench_load_file();
+    if (bench_enabled(argc, argv, "huge_pages")) bench_huge_pages();
+    if (bench_enabled(argc, argv, "atomic_push")) bench_atomic_push();
+    if (bench_enabled(argc, argv, "snapshot")) bench_snapshot_restore();
+    return 0;
+}
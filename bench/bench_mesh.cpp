@@ -0,0 +1,417 @@
+#include "bench.h"
+#include "math_batch.h"
+#include "mathlib.h"
+#include "memory.h"
+#include "mesh.h"
+
+// Mesh processing loops over Array<Vec3> with three ways of indexing:
+//   - the unconditional ASSERT(idx < size) operator[] had before assertion levels,
+//   - operator[] as it is now, whose ASSERT_DEBUG is compiled out in this optimized build,
+//   - get_unchecked and range-based loops.
+// The mesh is a grid of quads split into two triangles, small enough for L1 and large enough
+// to stream from memory.
+
+struct Asserted_Access
+{
+    template <typename T>
+    static T& at(Array<T>& a, s64 idx)
+    {
+        ASSERT(idx < a.size);
+        return a.array[idx];
+    }
+};
+
+struct Operator_Access
+{
+    template <typename T>
+    static T& at(Array<T>& a, s64 idx)
+    {
+        return a[idx];
+    }
+};
+
+struct Unchecked_Access
+{
+    template <typename T>
+    static T& at(Array<T>& a, s64 idx)
+    {
+        return a.get_unchecked(idx);
+    }
+};
+
+struct Bench_Mesh
+{
+    Array<Vec3> positions;
+    Array<Vec3> normals;
+    Array<u32> indices;
+};
+
+static Bench_Mesh make_grid(Arena* arena, s64 side)
+{
+    Bench_Mesh mesh;
+    mesh.positions = arena_push_array_with_count<Vec3>(arena, side * side, side * side);
+    mesh.normals = arena_push_array_with_count<Vec3>(arena, side * side, side * side);
+    mesh.indices = arena_push_array_with_count<u32>(arena, (side - 1) * (side - 1) * 6, (side - 1) * (side - 1) * 6);
+
+    u64 state = 11;
+    for (s64 y = 0; y < side; ++y)
+    {
+        for (s64 x = 0; x < side; ++x)
+        {
+            mesh.positions[y * side + x] = Vec3{ f32(x), bench_random_f32(&state, -1.0f, 1.0f), f32(y) };
+        }
+    }
+
+    s64 i = 0;
+    for (s64 y = 0; y + 1 < side; ++y)
+    {
+        for (s64 x = 0; x + 1 < side; ++x)
+        {
+            u32 v = u32(y * side + x);
+            u32 const quad[] = { v, v + u32(side), v + 1, v + 1, v + u32(side), v + u32(side) + 1 };
+            for (u32 idx : quad)
+            {
+                mesh.indices[i++] = idx;
+            }
+        }
+    }
+    return mesh;
+}
+
+static f32 min_f32(f32 a, f32 b)
+{
+    return a < b ? a : b;
+}
+
+template <typename Access>
+static void mesh_bounds(Bench_Mesh* mesh, Vec3* out_min, Vec3* out_max)
+{
+    Vec3 lo = Access::at(mesh->positions, 0);
+    Vec3 hi = lo;
+    for (s64 i = 1; i < mesh->positions.count; ++i)
+    {
+        Vec3 p = Access::at(mesh->positions, i);
+        lo = Vec3{ min_f32(lo.x, p.x), min_f32(lo.y, p.y), min_f32(lo.z, p.z) };
+        hi = Vec3{ math_max(hi.x, p.x), math_max(hi.y, p.y), math_max(hi.z, p.z) };
+    }
+    *out_min = lo;
+    *out_max = hi;
+}
+
+static void mesh_bounds_range_for(Bench_Mesh* mesh, Vec3* out_min, Vec3* out_max)
+{
+    Vec3 lo = mesh->positions.get_unchecked(0);
+    Vec3 hi = lo;
+    for (Vec3 p : mesh->positions)
+    {
+        lo = Vec3{ min_f32(lo.x, p.x), min_f32(lo.y, p.y), min_f32(lo.z, p.z) };
+        hi = Vec3{ math_max(hi.x, p.x), math_max(hi.y, p.y), math_max(hi.z, p.z) };
+    }
+    *out_min = lo;
+    *out_max = hi;
+}
+
+template <typename Access>
+static void mesh_transform(Bench_Mesh* mesh, Vec3 scale, Vec3 offset)
+{
+    for (s64 i = 0; i < mesh->positions.count; ++i)
+    {
+        Vec3& p = Access::at(mesh->positions, i);
+        p = p * scale + offset;
+    }
+}
+
+static void mesh_transform_range_for(Bench_Mesh* mesh, Vec3 scale, Vec3 offset)
+{
+    for (Vec3& p : mesh->positions)
+    {
+        p = p * scale + offset;
+    }
+}
+
+// Area weighted vertex normals, the gathers and scatters through the index buffer are where
+// every access pays for its bounds check.
+template <typename Access>
+static void mesh_normals(Bench_Mesh* mesh)
+{
+    for (s64 i = 0; i < mesh->normals.count; ++i)
+    {
+        Access::at(mesh->normals, i) = Vec3{};
+    }
+    for (s64 i = 0; i + 2 < mesh->indices.count; i += 3)
+    {
+        u32 i0 = Access::at(mesh->indices, i);
+        u32 i1 = Access::at(mesh->indices, i + 1);
+        u32 i2 = Access::at(mesh->indices, i + 2);
+        Vec3 p0 = Access::at(mesh->positions, i0);
+        Vec3 n = cross(Access::at(mesh->positions, i1) - p0, Access::at(mesh->positions, i2) - p0);
+        Access::at(mesh->normals, i0) = Access::at(mesh->normals, i0) + n;
+        Access::at(mesh->normals, i1) = Access::at(mesh->normals, i1) + n;
+        Access::at(mesh->normals, i2) = Access::at(mesh->normals, i2) + n;
+    }
+    for (s64 i = 0; i < mesh->normals.count; ++i)
+    {
+        Vec3& n = Access::at(mesh->normals, i);
+        n = normalized(n);
+    }
+}
+
+static void bench_mesh_loops(s64 side)
+{
+    s64 const num_vertices = side * side;
+    s32 const runs = 10;
+    // Small meshes are processed several times per run so every run takes a few milliseconds.
+    s64 const repeats = (4 * 1024 * 1024 + num_vertices - 1) / num_vertices;
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+    Bench_Mesh mesh = make_grid(&arena, side);
+    s64 const num_triangles = mesh.indices.count / 3;
+
+    char title[96];
+    snprintf(title, sizeof(title), "Mesh loops over Array<Vec3>, %lld vertices, %lld triangles", num_vertices, num_triangles);
+    bench_section(title);
+
+    Vec3 lo, hi;
+    auto report_bounds = [&](char const* label, auto&& fn) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                fn(&mesh, &lo, &hi);
+                bench_keep(lo);
+                bench_keep(hi);
+            }
+        });
+        bench_report_ns(label, t, num_vertices * repeats);
+    };
+    report_bounds("bounds, ASSERT operator[] (before)", mesh_bounds<Asserted_Access>);
+    report_bounds("bounds, operator[]", mesh_bounds<Operator_Access>);
+    report_bounds("bounds, get_unchecked", mesh_bounds<Unchecked_Access>);
+    report_bounds("bounds, range-for", mesh_bounds_range_for);
+
+    // Scales by one and offsets by zero so repeated runs don't drift the positions.
+    Vec3 const scale = Vec3{ 1.0f, 1.0f, 1.0f };
+    Vec3 const offset = Vec3{ 0.0f, 0.0f, 0.0f };
+    auto report_transform = [&](char const* label, auto&& fn) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                fn(&mesh, scale, offset);
+                bench_keep(*mesh.positions.array);
+            }
+        });
+        bench_report_ns(label, t, num_vertices * repeats);
+    };
+    report_transform("transform, ASSERT operator[] (before)", mesh_transform<Asserted_Access>);
+    report_transform("transform, operator[]", mesh_transform<Operator_Access>);
+    report_transform("transform, get_unchecked", mesh_transform<Unchecked_Access>);
+    report_transform("transform, range-for", mesh_transform_range_for);
+
+    s64 const normal_repeats = (repeats + 3) / 4;
+    auto report_normals = [&](char const* label, auto&& fn) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 r = 0; r < normal_repeats; ++r)
+            {
+                fn(&mesh);
+                bench_keep(*mesh.normals.array);
+            }
+        });
+        bench_report_ns(label, t, num_triangles * normal_repeats);
+    };
+    report_normals("vertex normals, ASSERT operator[] (before)", mesh_normals<Asserted_Access>);
+    report_normals("vertex normals, operator[]", mesh_normals<Operator_Access>);
+    report_normals("vertex normals, get_unchecked", mesh_normals<Unchecked_Access>);
+}
+
+static Slice<Vec3> as_slice(Array<Vec3> const& a)
+{
+    Slice<Vec3> slice;
+    slice.array = a.array;
+    slice.count = a.count;
+    return slice;
+}
+
+// Sums what fetch returns for every vertex into four independent accumulators, so the loop is
+// bound by loading and converting the streams rather than by the latency of one chain of adds.
+template <typename Fetch>
+static Vec3 sum_vertices(s64 num_vertices, Fetch&& fetch)
+{
+    ASSERT(num_vertices % 4 == 0);
+    Vec3 acc[4] = {};
+    for (s64 i = 0; i < num_vertices; i += 4)
+    {
+        acc[0] = acc[0] + fetch(i);
+        acc[1] = acc[1] + fetch(i + 1);
+        acc[2] = acc[2] + fetch(i + 2);
+        acc[3] = acc[3] + fetch(i + 3);
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+}
+
+// The fp32 vertex streams against the packed ones from mesh.h. GPU vertex fetch can't be measured
+// here, so the CPU side stands in for it:
+//   - the bytes each layout uploads,
+//   - packing, which create_model pays once per mesh,
+//   - copying into a staging buffer, which scales with the upload size,
+//   - reading the streams, once as raw bytes and once converted to floats as vertex fetch plus
+//     the octahedral decode in basic.vert.glsl would. The bounds remap is folded into the model
+//     matrix for both layouts, so it is left out.
+static void bench_vertex_bandwidth(s64 side)
+{
+    s64 const num_vertices = side * side;
+    s32 const runs = 10;
+    s64 const repeats = (4 * 1024 * 1024 + num_vertices - 1) / num_vertices;
+
+    Arena arena = arena_allocate(Arena_Params{ .zero_policy = Arena_Zero_Policy::NONE });
+    DEFER { arena_free(&arena); };
+    Bench_Mesh mesh = make_grid(&arena, side);
+    mesh_normals<Unchecked_Access>(&mesh);
+    Array<Vec3> colors = arena_push_array_with_count<Vec3>(&arena, num_vertices, num_vertices);
+    u64 state = 13;
+    for (Vec3& c : colors)
+    {
+        c = Vec3{ bench_random_f32(&state, 0.0f, 1.0f), bench_random_f32(&state, 0.0f, 1.0f), bench_random_f32(&state, 0.0f, 1.0f) };
+    }
+
+    AABB bounds = aabb_from_points(as_slice(mesh.positions));
+    Array<Packed_Position> packed_positions = mesh_pack_positions(&arena, as_slice(mesh.positions), bounds);
+    Array<Packed_Color> packed_colors = mesh_pack_colors(&arena, as_slice(colors));
+    Array<Packed_Normal> packed_normals = mesh_pack_normals(&arena, as_slice(mesh.normals));
+
+    u64 const fp32_size = sizeof(Vec3) + sizeof(Vec3);
+    u64 const packed_size = sizeof(Packed_Position) + sizeof(Packed_Color);
+    u64 const fp32_normal_size = fp32_size + sizeof(Vec3);
+    u64 const packed_normal_size = packed_size + sizeof(Packed_Normal);
+
+    char title[96];
+    snprintf(title, sizeof(title), "Vertex streams, fp32 against packed, %lld vertices", num_vertices);
+    bench_section(title);
+    printf("  position + color:          %2llu -> %2llu bytes/vertex, upload %8.2f -> %8.2f KiB\n",
+           fp32_size, packed_size, f64(fp32_size * num_vertices) / 1024.0, f64(packed_size * num_vertices) / 1024.0);
+    printf("  position + color + normal: %2llu -> %2llu bytes/vertex, upload %8.2f -> %8.2f KiB\n",
+           fp32_normal_size, packed_normal_size, f64(fp32_normal_size * num_vertices) / 1024.0, f64(packed_normal_size * num_vertices) / 1024.0);
+
+    Mark mark = arena_mark(&arena);
+    auto report_pack = [&](char const* label, auto&& fn) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                bench_keep(fn().array[0]);
+                arena_clear_to_mark(&arena, mark);
+            }
+        });
+        bench_report_ns(label, t, num_vertices * repeats);
+    };
+    report_pack("mesh_pack_positions", [&] { return mesh_pack_positions(&arena, as_slice(mesh.positions), bounds); });
+    report_pack("mesh_pack_colors", [&] { return mesh_pack_colors(&arena, as_slice(colors)); });
+    report_pack("mesh_pack_normals", [&] { return mesh_pack_normals(&arena, as_slice(mesh.normals)); });
+
+    // All streams of one layout copied back to back into one staging buffer.
+    struct Stream
+    {
+        void const* data;
+        u64 size;
+    };
+    u8* staging = (u8*)arena_push_no_zero(&arena, fp32_normal_size * num_vertices);
+    auto report_copy = [&](char const* label, u64 vertex_size, auto const& streams) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                u8* dst = staging;
+                for (Stream const& stream : streams)
+                {
+                    memcpy(dst, stream.data, stream.size);
+                    dst += stream.size;
+                }
+                bench_keep(*staging);
+            }
+        });
+        bench_report_bytes(label, t, vertex_size * num_vertices * repeats);
+    };
+    Stream const fp32_streams[] = {
+        { mesh.positions.array, sizeof(Vec3) * num_vertices },
+        { colors.array, sizeof(Vec3) * num_vertices },
+        { mesh.normals.array, sizeof(Vec3) * num_vertices },
+    };
+    Stream const packed_streams[] = {
+        { packed_positions.array, sizeof(Packed_Position) * num_vertices },
+        { packed_colors.array, sizeof(Packed_Color) * num_vertices },
+        { packed_normals.array, sizeof(Packed_Normal) * num_vertices },
+    };
+    report_copy("staging copy, fp32 with normals", fp32_normal_size, fp32_streams);
+    report_copy("staging copy, packed with normals", packed_normal_size, packed_streams);
+
+    // The same streams only summed as 64 bit words, so both layouts are bound by moving their bytes.
+    // This is the closest the CPU gets to fixed function vertex fetch, which converts the packed
+    // integers to floats for free.
+    auto report_raw_read = [&](char const* label, u64 vertex_size, auto const& streams) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                u64 acc[4] = {};
+                for (Stream const& stream : streams)
+                {
+                    ASSERT(stream.size % (4 * sizeof(u64)) == 0);
+                    u64 const* words = (u64 const*)stream.data;
+                    for (u64 i = 0; i < stream.size / sizeof(u64); i += 4)
+                    {
+                        acc[0] += words[i];
+                        acc[1] += words[i + 1];
+                        acc[2] += words[i + 2];
+                        acc[3] += words[i + 3];
+                    }
+                }
+                bench_keep(acc);
+            }
+        });
+        bench_report_bytes(label, t, vertex_size * num_vertices * repeats);
+    };
+    report_raw_read("read bytes only, fp32 with normals", fp32_normal_size, fp32_streams);
+    report_raw_read("read bytes only, packed with normals", packed_normal_size, packed_streams);
+
+    // Reading every stream and converting it to floats the way the shader sees them, including the
+    // octahedral decode. On the CPU this is mostly the divides of the unpack functions and the sqrt.
+    auto report_read = [&](char const* label, u64 vertex_size, auto&& fetch) {
+        f64 t = bench_best_of(runs, [&] {
+            for (s64 r = 0; r < repeats; ++r)
+            {
+                bench_keep(sum_vertices(num_vertices, fetch));
+            }
+        });
+        bench_report_bytes(label, t, vertex_size * num_vertices * repeats);
+    };
+    report_read("read position + color, fp32", fp32_size, [&](s64 i) {
+        return mesh.positions.get_unchecked(i) + colors.get_unchecked(i);
+    });
+    report_read("read position + color, packed", packed_size, [&](s64 i) {
+        Packed_Position p = packed_positions.get_unchecked(i);
+        Packed_Color c = packed_colors.get_unchecked(i);
+        return Vec3{ unpack_snorm16(p.x), unpack_snorm16(p.y), unpack_snorm16(p.z) } +
+               Vec3{ unpack_unorm8(c.r), unpack_unorm8(c.g), unpack_unorm8(c.b) };
+    });
+    report_read("read position + color + normal, fp32", fp32_normal_size, [&](s64 i) {
+        return mesh.positions.get_unchecked(i) + colors.get_unchecked(i) + mesh.normals.get_unchecked(i);
+    });
+    report_read("read position + color + normal, packed", packed_normal_size, [&](s64 i) {
+        Packed_Position p = packed_positions.get_unchecked(i);
+        Packed_Color c = packed_colors.get_unchecked(i);
+        return Vec3{ unpack_snorm16(p.x), unpack_snorm16(p.y), unpack_snorm16(p.z) } +
+               Vec3{ unpack_unorm8(c.r), unpack_unorm8(c.g), unpack_unorm8(c.b) } +
+               unpack_normal(packed_normals.get_unchecked(i));
+    });
+}
+
+int main(int argc, char** argv)
+{
+    if (bench_enabled(argc, argv, "loops"))
+    {
+        bench_mesh_loops(64);
+        bench_mesh_loops(1024);
+    }
+    if (bench_enabled(argc, argv, "bandwidth"))
+    {
+        bench_vertex_bandwidth(64);
+        bench_vertex_bandwidth(1024);
+    }
+    return 0;
+}
@@ -1,6 +1,17 @@
 #pragma once
+#include "core.h"
 
 struct Arena;
+struct Job_System;
+
+enum class Subsystem : u8
+{
+    RENDERER,
+    ASSETS,
+    SHADERS,
+    UI,
+    COUNT
+};
 
 struct Context
 {
@@ -12,5 +23,23 @@ struct Context
     // The allocator to use for memory with short lifetimes. We make no guarantees that allocations
     // taken from it stay valid for longer than a frame, and may verify that everything has been freed
     // at the end of the frame. Generally, allocations from tmp_bump should be freed as soon as they are not needed anymore.
+    // Function-local temporaries should prefer the thread's scratch arenas (see scratch_begin in memory.h).
     Arena* tmp_bump = nullptr;
-};
\ No newline at end of file
+
+    // The allocator for data that has to outlive the frame it was created in, e.g. because
+    // commands recorded this frame reference it. Its contents stay valid until the GPU has
+    // finished the frame, after which the arena is reset for the next use of the same frame slot.
+    Arena* frame_bump = nullptr;
+
+    // Child arenas of bump, one per subsystem. Each has a fixed budget, so permanent data that belongs
+    // to one subsystem should go here instead of bump. See arena_create_child in memory.h.
+    Arena* subsystem_bumps[u8(Subsystem::COUNT)] = {};
+
+    // Worker threads for splitting up data parallel work, see jobs.h.
+    Job_System* jobs = nullptr;
+};
+
+static inline Arena* subsystem_bump(Context* ctx, Subsystem subsystem)
+{
+    return ctx->subsystem_bumps[u8(subsystem)];
+}
\ No newline at end of file
@@ -48,6 +48,135 @@ using f64 = double;
 
 #define ARRAYSIZE(a) (sizeof(a) / sizeof(*(a)))
 
+struct Source_Location
+{
+    char const* file = nullptr;
+    u32 line = 0;
+
+    // When used as a default argument this evaluates to the location of the caller.
+    static constexpr Source_Location current(char const* file = __builtin_FILE(), u32 line = __builtin_LINE())
+    {
+        return Source_Location{file, line};
+    }
+};
+
+#define SOURCE_LOCATION_CURRENT Source_Location::current()
+
+#if PLATFORM_WIN32
+#include <intrin.h>
+#endif
+
+// Index of the highest set bit. v must not be zero.
+static inline u32 bit_scan_reverse(u64 v)
+{
+#if PLATFORM_WIN32
+    unsigned long idx;
+    _BitScanReverse64(&idx, v);
+    return idx;
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+// Index of the lowest set bit. v must not be zero.
+static inline u32 bit_scan_forward(u64 v)
+{
+#if PLATFORM_WIN32
+    unsigned long idx;
+    _BitScanForward64(&idx, v);
+    return idx;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+static constexpr bool is_pow2(u64 v)
+{
+    return v && ((v & (v - 1)) == 0);
+}
+
+// Minimal atomics for the few places that share state between threads without a lock.
+// Loads acquire and stores release, read-modify-write operations are sequentially consistent.
+static inline u64 atomic_load_u64(u64 volatile* p)
+{
+#if PLATFORM_WIN32
+    u64 v = *p;
+    _ReadWriteBarrier();
+    return v;
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void atomic_store_u64(u64 volatile* p, u64 v)
+{
+#if PLATFORM_WIN32
+    _ReadWriteBarrier();
+    *p = v;
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+// Returns the value before the add.
+static inline u64 atomic_fetch_add_u64(u64 volatile* p, u64 v)
+{
+#if PLATFORM_WIN32
+    return (u64)_InterlockedExchangeAdd64((__int64 volatile*)p, (__int64)v);
+#else
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Stores desired if *p still holds *expected. Otherwise loads the current value into *expected
+// and returns false, so the caller can retry with it.
+static inline bool atomic_compare_exchange_u64(u64 volatile* p, u64* expected, u64 desired)
+{
+#if PLATFORM_WIN32
+    u64 previous = (u64)_InterlockedCompareExchange64((__int64 volatile*)p, (__int64)desired, (__int64)*expected);
+    if (previous == *expected)
+    {
+        return true;
+    }
+    *expected = previous;
+    return false;
+#else
+    return __atomic_compare_exchange_n(p, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+// Returns the previous value.
+static inline u32 atomic_exchange_u32(u32 volatile* p, u32 v)
+{
+#if PLATFORM_WIN32
+    return (u32)_InterlockedExchange((long volatile*)p, (long)v);
+#else
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void atomic_store_u32(u32 volatile* p, u32 v)
+{
+#if PLATFORM_WIN32
+    _ReadWriteBarrier();
+    *p = v;
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+// Hint to the CPU that we're busy waiting.
+static inline void cpu_relax()
+{
+#if PLATFORM_WIN32
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
 template <typename T>
 struct DeferredFunction
 {
@@ -91,6 +220,41 @@ constexpr bool C_ALWAYS_FAILS = false;
 
 #define ASSERT_FAILED_MSG(msg, ...) ASSERT_MSG(C_ALWAYS_FAILS, msg, ##__VA_ARGS__)
 
+// ASSERT always runs. Checks that sit in hot loops (e.g. bounds checks) use ASSERT_DEBUG,
+// which only runs from ASSERT_LEVEL_DEBUG up, and checks that are expensive even for a
+// debug build use ASSERT_PARANOID. Define ASSERT_LEVEL to override the default per build.
+// Disabled checks keep their condition in an unevaluated context, so it still has to compile
+// and variables that are only used by it don't cause warnings.
+#define ASSERT_LEVEL_ALWAYS 0
+#define ASSERT_LEVEL_DEBUG 1
+#define ASSERT_LEVEL_PARANOID 2
+
+#ifndef ASSERT_LEVEL
+#if DEBUG_BUILD
+#define ASSERT_LEVEL ASSERT_LEVEL_DEBUG
+#else
+#define ASSERT_LEVEL ASSERT_LEVEL_ALWAYS
+#endif
+#endif
+
+#define ASSERT_DISABLED(condition) ((void)sizeof(bool(condition)))
+
+#if ASSERT_LEVEL >= ASSERT_LEVEL_DEBUG
+#define ASSERT_DEBUG(condition) ASSERT(condition)
+#define ASSERT_DEBUG_MSG(condition, msg, ...) ASSERT_MSG(condition, msg, ##__VA_ARGS__)
+#else
+#define ASSERT_DEBUG(condition) ASSERT_DISABLED(condition)
+#define ASSERT_DEBUG_MSG(condition, msg, ...) ASSERT_DISABLED(condition)
+#endif
+
+#if ASSERT_LEVEL >= ASSERT_LEVEL_PARANOID
+#define ASSERT_PARANOID(condition) ASSERT(condition)
+#define ASSERT_PARANOID_MSG(condition, msg, ...) ASSERT_MSG(condition, msg, ##__VA_ARGS__)
+#else
+#define ASSERT_PARANOID(condition) ASSERT_DISABLED(condition)
+#define ASSERT_PARANOID_MSG(condition, msg, ...) ASSERT_DISABLED(condition)
+#endif
+
 void log_message(char const* fmt, ...);
 
 #define LOG(fmt, ...) log_message(fmt, ##__VA_ARGS__);
@@ -0,0 +1,119 @@
+#pragma once
+#include "core.h"
+
+// Fast non-cryptographic 64-bit hashing, based on the multiply-mix construction used by wyhash.
+// Good enough distribution for hash tables and content keys, not suitable against adversarial input.
+
+constexpr u64 C_HASH_DEFAULT_SEED = 0xa0761d6478bd642full;
+
+namespace detail
+{
+    constexpr u64 C_HASH_P1 = 0xe7037ed1a0b428dbull;
+    constexpr u64 C_HASH_P2 = 0x8ebc6af09c88c6e3ull;
+    constexpr u64 C_HASH_P3 = 0x589965cc75374cc3ull;
+
+    // 64x64 -> 128 bit multiply, folded back to 64 bits.
+    static inline u64 hash_mix(u64 a, u64 b)
+    {
+#if PLATFORM_WIN32
+        u64 hi;
+        u64 lo = _umul128(a, b, &hi);
+        return lo ^ hi;
+#else
+        __uint128_t r = __uint128_t(a) * b;
+        return u64(r) ^ u64(r >> 64);
+#endif
+    }
+
+    static inline u64 hash_read64(u8 const* p)
+    {
+        u64 v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    static inline u64 hash_read32(u8 const* p)
+    {
+        u32 v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // Reads 1 to 3 bytes without branching on the exact length.
+    static inline u64 hash_read_small(u8 const* p, u64 len)
+    {
+        return (u64(p[0]) << 16) | (u64(p[len >> 1]) << 8) | p[len - 1];
+    }
+}
+
+static inline u64 hash_bytes(void const* data, u64 len, u64 seed = C_HASH_DEFAULT_SEED)
+{
+    using namespace detail;
+
+    u8 const* p = (u8 const*)data;
+    seed ^= hash_mix(seed ^ C_HASH_P1, C_HASH_P2);
+
+    u64 a = 0;
+    u64 b = 0;
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (hash_read32(p) << 32) | hash_read32(p + ((len >> 3) << 2));
+            b = (hash_read32(p + len - 4) << 32) | hash_read32(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = hash_read_small(p, len);
+        }
+    }
+    else
+    {
+        u64 i = len;
+        if (i > 48)
+        {
+            u64 see1 = seed;
+            u64 see2 = seed;
+            do
+            {
+                seed = hash_mix(hash_read64(p) ^ C_HASH_P1, hash_read64(p + 8) ^ seed);
+                see1 = hash_mix(hash_read64(p + 16) ^ C_HASH_P2, hash_read64(p + 24) ^ see1);
+                see2 = hash_mix(hash_read64(p + 32) ^ C_HASH_P3, hash_read64(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16)
+        {
+            seed = hash_mix(hash_read64(p) ^ C_HASH_P1, hash_read64(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
+    }
+
+    a ^= C_HASH_P1;
+    b ^= seed;
+    u64 ab = hash_mix(a, b);
+    return hash_mix(ab ^ C_HASH_P1 ^ len, b ^ C_HASH_P2);
+}
+
+static inline u64 hash_u64(u64 v)
+{
+    return detail::hash_mix(v ^ detail::C_HASH_P1, C_HASH_DEFAULT_SEED);
+}
+
+static inline u64 hash_string(String s, u64 seed = C_HASH_DEFAULT_SEED)
+{
+    return hash_bytes(s.buffer, s.len, seed);
+}
+
+// Combine an existing hash with more data, e.g. when hashing several fields of a cache key.
+static inline u64 hash_combine(u64 h, u64 v)
+{
+    return detail::hash_mix(h ^ detail::C_HASH_P2, v ^ detail::C_HASH_P3);
+}
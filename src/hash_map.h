@@ -0,0 +1,458 @@
+#pragma once
+#include "core.h"
+#include "hash.h"
+#include "memory.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HASH_MAP_SSE2 1
+#define HASH_MAP_NEON 0
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define HASH_MAP_SSE2 0
+#define HASH_MAP_NEON 1
+#else
+#define HASH_MAP_SSE2 0
+#define HASH_MAP_NEON 0
+#endif
+
+// Open addressing hash map in the style of Swiss tables.
+// Next to the slots we keep one control byte per slot, which is either empty, deleted or
+// holds the low 7 bits of the key's hash. Lookups compare a whole group of 16 control
+// bytes against those 7 bits at once, and only touch slots whose control byte matched.
+//
+// Storage comes from the given Arena, or from the general heap if no arena is given.
+// Growing an arena backed map leaves the old table behind in the arena, so arena maps
+// should be created with a good estimate of their final size.
+//
+// Keys are hashed and compared through hash_key / keys_equal. Overloads exist for String
+// and integers, everything else is treated as plain bytes, so key structs must not have
+// uninitialized padding.
+
+constexpr s64 C_HASH_MAP_GROUP_SIZE = 16;
+
+namespace detail
+{
+    constexpr u8 C_CTRL_EMPTY = 0x80;
+    constexpr u8 C_CTRL_DELETED = 0xFE;
+
+    static inline bool ctrl_is_full(u8 ctrl) { return (ctrl & 0x80) == 0; }
+
+    // Bitmask with one bit per control byte in a group of 16.
+    struct Group_Mask
+    {
+        u32 bits = 0;
+
+        bool any() const { return bits != 0; }
+        u32 next() { u32 idx = bit_scan_forward(bits); bits &= bits - 1; return idx; }
+    };
+
+    struct Group
+    {
+#if HASH_MAP_SSE2
+        __m128i ctrl;
+
+        explicit Group(u8 const* p) : ctrl(_mm_loadu_si128((__m128i const*)p)) {}
+
+        Group_Mask match(u8 h2) const
+        {
+            return {u32(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(char(h2)))))};
+        }
+
+        Group_Mask match_empty() const
+        {
+            return match(C_CTRL_EMPTY);
+        }
+
+        // Empty and deleted both have the high bit set, full slots never do.
+        Group_Mask match_empty_or_deleted() const
+        {
+            return {u32(_mm_movemask_epi8(ctrl))};
+        }
+#elif HASH_MAP_NEON
+        uint8x16_t ctrl;
+
+        explicit Group(u8 const* p) : ctrl(vld1q_u8(p)) {}
+
+        static u32 movemask(uint8x16_t v)
+        {
+            static u8 const bit_weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+            uint8x16_t bits = vandq_u8(v, vld1q_u8(bit_weights));
+            u32 lo = vaddv_u8(vget_low_u8(bits));
+            u32 hi = vaddv_u8(vget_high_u8(bits));
+            return lo | (hi << 8);
+        }
+
+        Group_Mask match(u8 h2) const
+        {
+            return {movemask(vceqq_u8(ctrl, vdupq_n_u8(h2)))};
+        }
+
+        Group_Mask match_empty() const
+        {
+            return match(C_CTRL_EMPTY);
+        }
+
+        Group_Mask match_empty_or_deleted() const
+        {
+            return {movemask(vcltq_s8(vreinterpretq_s8_u8(ctrl), vdupq_n_s8(0)))};
+        }
+#else
+        u8 ctrl[C_HASH_MAP_GROUP_SIZE];
+
+        explicit Group(u8 const* p) { memcpy(ctrl, p, sizeof(ctrl)); }
+
+        Group_Mask match(u8 h2) const
+        {
+            u32 bits = 0;
+            for (u32 i = 0; i < C_HASH_MAP_GROUP_SIZE; ++i)
+            {
+                bits |= u32(ctrl[i] == h2) << i;
+            }
+            return {bits};
+        }
+
+        Group_Mask match_empty() const
+        {
+            return match(C_CTRL_EMPTY);
+        }
+
+        Group_Mask match_empty_or_deleted() const
+        {
+            u32 bits = 0;
+            for (u32 i = 0; i < C_HASH_MAP_GROUP_SIZE; ++i)
+            {
+                bits |= u32(!ctrl_is_full(ctrl[i])) << i;
+            }
+            return {bits};
+        }
+#endif
+    };
+}
+
+static inline u64 hash_key(String const& key) { return hash_string(key); }
+static inline u64 hash_key(u32 key) { return hash_u64(key); }
+static inline u64 hash_key(u64 key) { return hash_u64(key); }
+static inline u64 hash_key(s32 key) { return hash_u64(u64(key)); }
+static inline u64 hash_key(s64 key) { return hash_u64(u64(key)); }
+
+template <typename K>
+u64 hash_key(K const& key)
+{
+    return hash_bytes(&key, sizeof(K));
+}
+
+static inline bool keys_equal(String const& lhs, String const& rhs)
+{
+    return lhs.len == rhs.len && memcmp(lhs.buffer, rhs.buffer, lhs.len) == 0;
+}
+
+static inline bool keys_equal(u32 lhs, u32 rhs) { return lhs == rhs; }
+static inline bool keys_equal(u64 lhs, u64 rhs) { return lhs == rhs; }
+static inline bool keys_equal(s32 lhs, s32 rhs) { return lhs == rhs; }
+static inline bool keys_equal(s64 lhs, s64 rhs) { return lhs == rhs; }
+
+template <typename K>
+bool keys_equal(K const& lhs, K const& rhs)
+{
+    return memcmp(&lhs, &rhs, sizeof(K)) == 0;
+}
+
+template <typename K, typename V>
+struct Hash_Map_Slot
+{
+    K key;
+    V value;
+};
+
+template <typename K, typename V>
+struct Hash_Map
+{
+    using Slot = Hash_Map_Slot<K, V>;
+
+    Arena* arena = nullptr; // nullptr means storage comes from malloc.
+    u8* ctrl = nullptr;
+    Slot* slots = nullptr;
+    s64 capacity = 0;       // Always a multiple of the group size.
+    s64 count = 0;
+    s64 growth_left = 0;    // Inserts left before we need to rehash, deleted slots count as used.
+
+    struct Iterator
+    {
+        Hash_Map const* map = nullptr;
+        s64 idx = 0;
+
+        void skip_to_full()
+        {
+            while (idx < map->capacity && !detail::ctrl_is_full(map->ctrl[idx]))
+            {
+                ++idx;
+            }
+        }
+
+        Slot& operator*() const { return map->slots[idx]; }
+        Iterator& operator++() { ++idx; skip_to_full(); return *this; }
+        bool operator!=(Iterator const& other) const { return idx != other.idx; }
+    };
+
+    Iterator begin() const
+    {
+        Iterator it{this, 0};
+        if (capacity)
+        {
+            it.skip_to_full();
+        }
+        return it;
+    }
+
+    Iterator end() const { return Iterator{this, capacity}; }
+};
+
+namespace detail
+{
+    // Upper bits select the group to start probing at, the low 7 bits are stored in the control byte.
+    static inline u64 hash_h1(u64 hash) { return hash >> 7; }
+    static inline u8 hash_h2(u64 hash) { return u8(hash & 0x7F); }
+
+    static inline s64 hash_map_max_load(s64 capacity)
+    {
+        return capacity - capacity / 8; // 7/8 load factor
+    }
+
+    template <typename K, typename V>
+    void hash_map_alloc_storage(Hash_Map<K, V>* map, s64 capacity)
+    {
+        using Slot = Hash_Map_Slot<K, V>;
+
+        if (map->arena)
+        {
+            map->ctrl = (u8*)arena_push_no_zero_a(map->arena, capacity, C_HASH_MAP_GROUP_SIZE);
+            map->slots = (Slot*)arena_push_no_zero_a(map->arena, sizeof(Slot) * capacity, alignof(Slot));
+        }
+        else
+        {
+            map->ctrl = (u8*)malloc(capacity);
+            map->slots = (Slot*)malloc(sizeof(Slot) * capacity);
+        }
+
+        memset(map->ctrl, C_CTRL_EMPTY, capacity);
+        map->capacity = capacity;
+        map->growth_left = hash_map_max_load(capacity);
+    }
+
+    template <typename K, typename V>
+    void hash_map_free_storage(Hash_Map<K, V>* map)
+    {
+        if (!map->arena)
+        {
+            free(map->ctrl);
+            free(map->slots);
+        }
+        map->ctrl = nullptr;
+        map->slots = nullptr;
+    }
+
+    // Finds the first empty or deleted slot on the probe sequence of the given hash.
+    template <typename K, typename V>
+    s64 hash_map_find_insert_slot(Hash_Map<K, V>* map, u64 hash)
+    {
+        s64 group_mask = map->capacity / C_HASH_MAP_GROUP_SIZE - 1;
+        s64 group = s64(hash_h1(hash)) & group_mask;
+
+        // Triangular probing visits every group exactly once when the group count is a power of two.
+        for (s64 step = 1;; ++step)
+        {
+            s64 base = group * C_HASH_MAP_GROUP_SIZE;
+            Group_Mask free_slots = Group(map->ctrl + base).match_empty_or_deleted();
+            if (free_slots.any())
+            {
+                return base + free_slots.next();
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    template <typename K, typename V>
+    void hash_map_rehash(Hash_Map<K, V>* map, s64 new_capacity)
+    {
+        Hash_Map<K, V> old = *map;
+        hash_map_alloc_storage(map, new_capacity);
+
+        for (s64 i = 0; i < old.capacity; ++i)
+        {
+            if (ctrl_is_full(old.ctrl[i]))
+            {
+                u64 hash = hash_key(old.slots[i].key);
+                s64 idx = hash_map_find_insert_slot(map, hash);
+                map->ctrl[idx] = hash_h2(hash);
+                map->slots[idx] = old.slots[i];
+            }
+        }
+        map->growth_left -= map->count;
+
+        hash_map_free_storage(&old);
+    }
+}
+
+template <typename K, typename V>
+Hash_Map<K, V> hash_map_create(Arena* arena, s64 expected_count = 0)
+{
+    // Size the table so expected_count inserts fit below the max load factor.
+    s64 capacity = C_HASH_MAP_GROUP_SIZE;
+    while (detail::hash_map_max_load(capacity) < expected_count)
+    {
+        capacity *= 2;
+    }
+
+    Hash_Map<K, V> map;
+    map.arena = arena;
+    detail::hash_map_alloc_storage(&map, capacity);
+    return map;
+}
+
+template <typename K, typename V>
+void hash_map_destroy(Hash_Map<K, V>* map)
+{
+    detail::hash_map_free_storage(map);
+    map->capacity = 0;
+    map->count = 0;
+    map->growth_left = 0;
+}
+
+template <typename K, typename V>
+void hash_map_clear(Hash_Map<K, V>* map)
+{
+    memset(map->ctrl, detail::C_CTRL_EMPTY, map->capacity);
+    map->count = 0;
+    map->growth_left = detail::hash_map_max_load(map->capacity);
+}
+
+namespace detail
+{
+    // Returns the slot index holding key, or -1 if the key isn't in the map.
+    template <typename K, typename V>
+    s64 hash_map_find_index(Hash_Map<K, V>* map, K const& key, u64 hash)
+    {
+        u8 h2 = hash_h2(hash);
+        s64 group_mask = map->capacity / C_HASH_MAP_GROUP_SIZE - 1;
+        s64 group = s64(hash_h1(hash)) & group_mask;
+
+        for (s64 step = 1; step <= group_mask + 1; ++step)
+        {
+            s64 base = group * C_HASH_MAP_GROUP_SIZE;
+            Group g(map->ctrl + base);
+
+            Group_Mask candidates = g.match(h2);
+            while (candidates.any())
+            {
+                s64 idx = base + candidates.next();
+                if (keys_equal(map->slots[idx].key, key))
+                {
+                    return idx;
+                }
+            }
+
+            // An empty slot in the group means the key was never pushed further down the probe sequence.
+            if (g.match_empty().any())
+            {
+                return -1;
+            }
+
+            group = (group + step) & group_mask;
+        }
+
+        return -1;
+    }
+}
+
+template <typename K, typename V>
+V* hash_map_find(Hash_Map<K, V>* map, K const& key)
+{
+    s64 idx = detail::hash_map_find_index(map, key, hash_key(key));
+    return (idx >= 0) ? &map->slots[idx].value : nullptr;
+}
+
+// Returns the slot for key, inserting it with a zero-initialized value if it wasn't in the map yet.
+// The key of a newly added slot may be replaced by an equal key, e.g. to point it at owned storage.
+template <typename K, typename V>
+Hash_Map_Slot<K, V>* hash_map_find_or_add_slot(Hash_Map<K, V>* map, K const& key, bool* was_added = nullptr)
+{
+    using namespace detail;
+
+    u64 hash = hash_key(key);
+    s64 existing = hash_map_find_index(map, key, hash);
+    if (existing >= 0)
+    {
+        if (was_added)
+        {
+            *was_added = false;
+        }
+        return &map->slots[existing];
+    }
+
+    if (map->growth_left == 0)
+    {
+        // If most of the used up growth is tombstones, rehashing at the same size is enough to reclaim them.
+        s64 new_capacity = (map->count * 2 < hash_map_max_load(map->capacity)) ? map->capacity : map->capacity * 2;
+        hash_map_rehash(map, new_capacity);
+    }
+
+    s64 idx = hash_map_find_insert_slot(map, hash);
+    if (map->ctrl[idx] == C_CTRL_EMPTY)
+    {
+        --map->growth_left; // Reusing a tombstone doesn't consume growth.
+    }
+
+    map->ctrl[idx] = hash_h2(hash);
+    map->slots[idx].key = key;
+    map->slots[idx].value = V{};
+    ++map->count;
+
+    if (was_added)
+    {
+        *was_added = true;
+    }
+    return &map->slots[idx];
+}
+
+// Returns the value for key, inserting a zero-initialized value if it wasn't in the map yet.
+template <typename K, typename V>
+V* hash_map_find_or_add(Hash_Map<K, V>* map, K const& key, bool* was_added = nullptr)
+{
+    return &hash_map_find_or_add_slot(map, key, was_added)->value;
+}
+
+// Inserts or overwrites the value stored for key.
+template <typename K, typename V>
+V* hash_map_insert(Hash_Map<K, V>* map, K const& key, V const& value)
+{
+    V* slot_value = hash_map_find_or_add(map, key);
+    *slot_value = value;
+    return slot_value;
+}
+
+template <typename K, typename V>
+bool hash_map_remove(Hash_Map<K, V>* map, K const& key)
+{
+    s64 idx = detail::hash_map_find_index(map, key, hash_key(key));
+    if (idx < 0)
+    {
+        return false;
+    }
+
+    // If the group still has an empty slot, no probe sequence can run past this slot,
+    // so we can mark it empty directly instead of leaving a tombstone.
+    s64 base = idx & ~(C_HASH_MAP_GROUP_SIZE - 1);
+    if (detail::Group(map->ctrl + base).match_empty().any())
+    {
+        map->ctrl[idx] = detail::C_CTRL_EMPTY;
+        ++map->growth_left;
+    }
+    else
+    {
+        map->ctrl[idx] = detail::C_CTRL_DELETED;
+    }
+
+    --map->count;
+    return true;
+}
@@ -0,0 +1,282 @@
+#include "jobs.h"
+
+#if PLATFORM_WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#elif PLATFORM_OSX
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#if PLATFORM_WIN32
+using Thread_Handle = HANDLE;
+using Mutex = SRWLOCK;
+using Cond_Var = CONDITION_VARIABLE;
+#else
+using Thread_Handle = pthread_t;
+using Mutex = pthread_mutex_t;
+using Cond_Var = pthread_cond_t;
+#endif
+
+struct Job_System
+{
+    Thread_Handle threads[C_JOBS_MAX_WORKERS];
+    s32 num_workers = 0;
+
+    // Everything below is protected by `lock`, except for the batch counters which
+    // the threads claim and complete with atomics while a range is open.
+    Mutex lock;
+    Cond_Var wake_workers;
+    Cond_Var range_done;
+    u64 generation = 0;
+    bool quit = false;
+
+    // A worker only joins the current range while it is open. The caller closes it once
+    // all batches are done and then waits for the workers still inside to leave, so no
+    // worker can touch the range fields once the next range is being set up.
+    bool range_open = false;
+    s32 active_workers = 0;
+
+    Job_Range_Fn fn = nullptr;
+    void* user = nullptr;
+    s64 count = 0;
+    s64 batch_size = 0;
+    u64 num_batches = 0;
+    u64 next_batch = 0;
+    u64 batches_done = 0;
+};
+
+static void mutex_lock(Mutex* mutex)
+{
+#if PLATFORM_WIN32
+    AcquireSRWLockExclusive(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+static void mutex_unlock(Mutex* mutex)
+{
+#if PLATFORM_WIN32
+    ReleaseSRWLockExclusive(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+static void cond_wait(Cond_Var* cond, Mutex* mutex)
+{
+#if PLATFORM_WIN32
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+static void cond_broadcast(Cond_Var* cond)
+{
+#if PLATFORM_WIN32
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+static s32 get_core_count()
+{
+#if PLATFORM_WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return s32(info.dwNumberOfProcessors);
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? s32(count) : 1;
+#endif
+}
+
+// Claims and runs batches until none are left. Returns true if this thread finished the last one.
+static bool run_batches(Job_System* jobs)
+{
+    bool finished_last = false;
+    for (;;)
+    {
+        u64 batch = atomic_fetch_add_u64(&jobs->next_batch, 1);
+        if (batch >= jobs->num_batches)
+        {
+            break;
+        }
+
+        s64 begin = s64(batch) * jobs->batch_size;
+        s64 end = (begin + jobs->batch_size < jobs->count) ? begin + jobs->batch_size : jobs->count;
+        jobs->fn(jobs->user, begin, end);
+
+        finished_last = (atomic_fetch_add_u64(&jobs->batches_done, 1) + 1 == jobs->num_batches);
+    }
+    return finished_last;
+}
+
+static void worker_loop(Job_System* jobs)
+{
+    u64 seen_generation = 0;
+
+    mutex_lock(&jobs->lock);
+    for (;;)
+    {
+        while (!jobs->quit && (jobs->generation == seen_generation || !jobs->range_open))
+        {
+            cond_wait(&jobs->wake_workers, &jobs->lock);
+        }
+
+        if (jobs->quit)
+        {
+            break;
+        }
+
+        seen_generation = jobs->generation;
+        ++jobs->active_workers;
+        mutex_unlock(&jobs->lock);
+
+        bool finished_last = run_batches(jobs);
+
+        mutex_lock(&jobs->lock);
+        --jobs->active_workers;
+        if (finished_last || jobs->active_workers == 0)
+        {
+            cond_broadcast(&jobs->range_done);
+        }
+    }
+    mutex_unlock(&jobs->lock);
+}
+
+#if PLATFORM_WIN32
+static DWORD WINAPI worker_entry(LPVOID param)
+{
+    worker_loop((Job_System*)param);
+    return 0;
+}
+#else
+static void* worker_entry(void* param)
+{
+    worker_loop((Job_System*)param);
+    return nullptr;
+}
+#endif
+
+Job_System* job_system_create(Arena* arena, s32 num_workers)
+{
+    if (num_workers < 0)
+    {
+        num_workers = get_core_count() - 1;
+    }
+    if (num_workers > C_JOBS_MAX_WORKERS)
+    {
+        num_workers = C_JOBS_MAX_WORKERS;
+    }
+
+    Job_System* jobs = arena_push_t<Job_System>(arena);
+    *jobs = Job_System{};
+
+#if PLATFORM_WIN32
+    InitializeSRWLock(&jobs->lock);
+    InitializeConditionVariable(&jobs->wake_workers);
+    InitializeConditionVariable(&jobs->range_done);
+#else
+    pthread_mutex_init(&jobs->lock, nullptr);
+    pthread_cond_init(&jobs->wake_workers, nullptr);
+    pthread_cond_init(&jobs->range_done, nullptr);
+#endif
+
+    for (s32 i = 0; i < num_workers; ++i)
+    {
+#if PLATFORM_WIN32
+        jobs->threads[i] = CreateThread(nullptr, 0, worker_entry, jobs, 0, nullptr);
+        bool created = jobs->threads[i] != nullptr;
+#else
+        bool created = pthread_create(&jobs->threads[i], nullptr, worker_entry, jobs) == 0;
+#endif
+        if (!created)
+        {
+            LOG("Failed to create job worker thread %d, continuing with %d workers.", i, i);
+            break;
+        }
+        ++jobs->num_workers;
+    }
+
+    return jobs;
+}
+
+void job_system_destroy(Job_System* jobs)
+{
+    mutex_lock(&jobs->lock);
+    jobs->quit = true;
+    cond_broadcast(&jobs->wake_workers);
+    mutex_unlock(&jobs->lock);
+
+    for (s32 i = 0; i < jobs->num_workers; ++i)
+    {
+#if PLATFORM_WIN32
+        WaitForSingleObject(jobs->threads[i], INFINITE);
+        CloseHandle(jobs->threads[i]);
+#else
+        pthread_join(jobs->threads[i], nullptr);
+#endif
+    }
+
+#if PLATFORM_OSX
+    pthread_cond_destroy(&jobs->range_done);
+    pthread_cond_destroy(&jobs->wake_workers);
+    pthread_mutex_destroy(&jobs->lock);
+#endif
+    jobs->num_workers = 0;
+}
+
+s32 job_system_worker_count(Job_System* jobs)
+{
+    return jobs->num_workers;
+}
+
+void job_parallel_for(Job_System* jobs, s64 count, s64 batch_size, Job_Range_Fn fn, void* user)
+{
+    ASSERT_MSG(batch_size > 0, "Batch size (%lld) must be positive.", batch_size);
+    if (count <= 0)
+    {
+        return;
+    }
+
+    u64 num_batches = u64((count + batch_size - 1) / batch_size);
+    if (!jobs || jobs->num_workers == 0 || num_batches == 1)
+    {
+        fn(user, 0, count);
+        return;
+    }
+
+    mutex_lock(&jobs->lock);
+    ASSERT_MSG(!jobs->range_open, "job_parallel_for is not reentrant.");
+    jobs->fn = fn;
+    jobs->user = user;
+    jobs->count = count;
+    jobs->batch_size = batch_size;
+    jobs->num_batches = num_batches;
+    jobs->next_batch = 0;
+    jobs->batches_done = 0;
+    jobs->range_open = true;
+    ++jobs->generation;
+    cond_broadcast(&jobs->wake_workers);
+    mutex_unlock(&jobs->lock);
+
+    run_batches(jobs);
+
+    mutex_lock(&jobs->lock);
+    while (atomic_load_u64(&jobs->batches_done) < num_batches)
+    {
+        cond_wait(&jobs->range_done, &jobs->lock);
+    }
+    jobs->range_open = false;
+    while (jobs->active_workers > 0)
+    {
+        cond_wait(&jobs->range_done, &jobs->lock);
+    }
+    mutex_unlock(&jobs->lock);
+}
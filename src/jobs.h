@@ -0,0 +1,28 @@
+#pragma once
+#include "core.h"
+#include "memory.h"
+
+// A small pool of worker threads for splitting data parallel work (transforming objects,
+// compiling shaders, ...) across cores. There are no individual jobs to track: the caller
+// hands over a range and job_parallel_for returns once all of it has been processed. The
+// calling thread works on the range as well, so a system without workers just runs it inline.
+//
+// Only one parallel_for runs at a time per Job_System, and the callback must not start
+// another one on the same system.
+
+constexpr s32 C_JOBS_MAX_WORKERS = 63;
+
+struct Job_System;
+
+// Called with a sub-range [begin, end) of the whole range.
+using Job_Range_Fn = void (*)(void* user, s64 begin, s64 end);
+
+// num_workers < 0 picks one worker per remaining core.
+Job_System* job_system_create(Arena* arena, s32 num_workers = -1);
+void job_system_destroy(Job_System* jobs);
+
+s32 job_system_worker_count(Job_System* jobs);
+
+// Splits [0, count) into batches of batch_size and processes them on all threads.
+// Blocks until every batch is done.
+void job_parallel_for(Job_System* jobs, s64 count, s64 batch_size, Job_Range_Fn fn, void* user);
@@ -1,13 +1,19 @@
 #include "core.h"
 #include "context.h"
+#include "jobs.h"
+#include "math_batch.h"
 #include "mathlib.h"
 #include "memory.h"
+#include "mesh.h"
 #include "platform.h"
+#include "pool.h"
 #include "shader_compiler.h"
+#include "str.h"
 #include "timer.h"
 #include "vk.h"
 
 constexpr s64 MAX_FRAMES_IN_FLIGHT = 2;
+constexpr s64 MAX_MODELS = 4096;
 
 #define ASSERT_IF_ERROR_ELSE_LOG(condition, fmt_string, ...) \
     if (condition)                                           \
@@ -90,14 +96,15 @@ static VkBool32 VKAPI_CALL debug_message_callback(VkDebugUtilsMessageSeverityFla
     return VK_FALSE; // Users should always return false according to spec.
 }
 
-u32 get_queue_family_index(VkPhysicalDevice phys_device, Context ctx, u32 queue_flags)
+u32 get_queue_family_index(VkPhysicalDevice phys_device, u32 queue_flags)
 {
-    ARENA_DEFER_CLEAR(ctx.tmp_bump);
+    Scratch scratch = scratch_begin();
+    SCRATCH_DEFER_END(scratch);
 
     u32 queue_count = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(phys_device, &queue_count, nullptr);
 
-    Array<VkQueueFamilyProperties> queue_props = arena_push_array<VkQueueFamilyProperties>(ctx.tmp_bump, queue_count);
+    Array<VkQueueFamilyProperties> queue_props = arena_push_array<VkQueueFamilyProperties>(scratch.arena, queue_count);
     vkGetPhysicalDeviceQueueFamilyProperties(phys_device, &queue_count, queue_props.array);
 
     for (u32 i = 0; i < queue_count; ++i)
@@ -204,7 +211,7 @@ static VkPhysicalDevice create_vk_physical_device(VkInstance vk_instance, VkSurf
 
         LOG("Enumerating GPU %s", props.deviceName);
 
-        u32 gfx_family_idx = get_queue_family_index(phys_devices[i], ctx, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+        u32 gfx_family_idx = get_queue_family_index(phys_devices[i], VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
         if (gfx_family_idx == VK_QUEUE_FAMILY_IGNORED)
         {
             continue;
@@ -814,6 +821,10 @@ struct Model
     GPU_Buffer vertices;
     GPU_Buffer colors;
     GPU_Buffer indices;
+    Mat4 dequantize = mat4_identity(); // Maps the packed positions back into model space, goes first in the model matrix.
+    // Model space, computed from the positions before they are packed.
+    AABB bounds;
+    Sphere bounding_sphere;
     int num_vertices = 0;
     int num_colors   = 0;
     int num_indices  = 0;
@@ -835,19 +846,26 @@ struct Vk_Ctx
     Upload_Ctx upload_ctx;
 };
 
-Model_Upload create_model(Vk_Ctx const* vk_ctx, Slice<Vec3> vertices, Slice<Vec3> colors, Slice<u16> indices)
+// The packed vertex streams go to scratch, they are copied into the staging buffers before this returns.
+Model_Upload create_model(Vk_Ctx const* vk_ctx, Arena* scratch, Slice<Vec3> vertices, Slice<Vec3> colors, Slice<u16> indices)
 {
     Model_Upload result;
 
+    result.model.bounds = aabb_from_points(vertices);
+    result.model.bounding_sphere = sphere_from_points(vertices);
+    Array<Packed_Position> packed_vertices = mesh_pack_positions(scratch, vertices, result.model.bounds);
+    Array<Packed_Color> packed_colors = mesh_pack_colors(scratch, colors);
+    result.model.dequantize = mesh_dequantize_matrix(result.model.bounds);
+
     result.model.vertices = create_gpu_buffer(vk_ctx->device, vk_ctx->phys_device, GPU_Buffer_Params {
-        .size = vertices.count * sizeof(Vec3), 
+        .size = packed_vertices.count * sizeof(Packed_Position), 
         .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
         .props = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
     });
     result.model.num_vertices = vertices.count;
 
     result.model.colors = create_gpu_buffer(vk_ctx->device, vk_ctx->phys_device, GPU_Buffer_Params {
-        .size = colors.count * sizeof(Vec3), 
+        .size = packed_colors.count * sizeof(Packed_Color), 
         .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
         .props = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
     });
@@ -861,10 +879,10 @@ Model_Upload create_model(Vk_Ctx const* vk_ctx, Slice<Vec3> vertices, Slice<Vec3
     result.model.num_indices = indices.count;
 
     result.vert_upload = upload_to_buffer(vk_ctx->device, vk_ctx->phys_device, 
-        vk_ctx->upload_ctx, result.model.vertices, (void*)vertices.array, vertices.count * sizeof(Vec3));
+        vk_ctx->upload_ctx, result.model.vertices, (void*)packed_vertices.array, packed_vertices.count * sizeof(Packed_Position));
 
     result.col_upload = upload_to_buffer(vk_ctx->device, vk_ctx->phys_device, 
-        vk_ctx->upload_ctx, result.model.colors, (void*)colors.array, colors.count * sizeof(Vec3));
+        vk_ctx->upload_ctx, result.model.colors, (void*)packed_colors.array, packed_colors.count * sizeof(Packed_Color));
 
     result.idx_upload = upload_to_buffer(vk_ctx->device, vk_ctx->phys_device,
         vk_ctx->upload_ctx, result.model.indices, (void*)indices.array, indices.count * sizeof(u16));
@@ -897,15 +915,32 @@ int main(int argc, char** argv)
     // one allocator, the permanent alloc blocks the temp ones from being freed. Example: loading a mesh, helper
     // allocations vs permanent mesh data alloc. With two, the helpers go on the temp (freed per scope or once
     // per frame -> then we can have two for rendering last frame async), the mesh data goes on the permanent stack.
-    Arena program_lifetime_allocator = arena_allocate(1024 * 1024 * 10); // Give ourselves 10 MiB of memory to place global lifetime allocs.
-    Arena temporary_lifetime_allocator = arena_allocate(1024 * 1024);  // And 1 MiB for temporary allocations (lifetime < 1 frame).
+    // Both only reserve address space, pages get committed as the arenas grow into them.
+    Arena program_lifetime_allocator = arena_allocate(Arena_Params{});
+    Arena temporary_lifetime_allocator = arena_allocate(Arena_Params{
+        .decommit_threshold = 1024 * 1024, // Hand back anything above 1 MiB once a temp scope spikes past it.
+    });
+    Frame_Arenas frame_lifetime_allocators = frame_arenas_create(MAX_FRAMES_IN_FLIGHT, Arena_Params{
+        .decommit_threshold = 1024 * 1024,
+    });
     DEFER  {
         arena_free(&program_lifetime_allocator);
-        arena_free(&temporary_lifetime_allocator); };
+        arena_free(&temporary_lifetime_allocator);
+        frame_arenas_destroy(&frame_lifetime_allocators); };
     Context ctx;
     ctx.bump = &program_lifetime_allocator;
     ctx.tmp_bump = &temporary_lifetime_allocator;
 
+    // Per subsystem budgets for permanent data. Exceeding one asserts, so raise them deliberately.
+    program_lifetime_allocator.name = "bump";
+    ctx.subsystem_bumps[u8(Subsystem::RENDERER)] = arena_create_child(ctx.bump, Arena_Child_Params{.name = "renderer", .budget = 64 * 1024 * 1024});
+    ctx.subsystem_bumps[u8(Subsystem::ASSETS)] = arena_create_child(ctx.bump, Arena_Child_Params{.name = "assets", .budget = 1024 * 1024 * 1024});
+    ctx.subsystem_bumps[u8(Subsystem::SHADERS)] = arena_create_child(ctx.bump, Arena_Child_Params{.name = "shaders", .budget = 16 * 1024 * 1024});
+    ctx.subsystem_bumps[u8(Subsystem::UI)] = arena_create_child(ctx.bump, Arena_Child_Params{.name = "ui", .budget = 64 * 1024 * 1024});
+
+    ctx.jobs = job_system_create(ctx.bump);
+    DEFER { job_system_destroy(ctx.jobs); };
+
     Platform_App platform_app = platform_create_app();
     
     char root_dir[MAX_PATH];
@@ -921,8 +956,6 @@ int main(int argc, char** argv)
         LOG("Root directory: \"%s\"", root_dir);
     }
 
-    test_mat4_mul();
-
     VK_CHECK(volkInitialize());
 
     Vk_Ctx vk_ctx;
@@ -951,7 +984,7 @@ int main(int argc, char** argv)
     VkPhysicalDevice vk_phys_device = create_vk_physical_device(vk_instance, vk_surface, phys_device_ext_slice, ctx);
     vk_ctx.phys_device = vk_phys_device;
 
-    u32 const gfx_family_idx = get_queue_family_index(vk_phys_device, ctx, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+    u32 const gfx_family_idx = get_queue_family_index(vk_phys_device, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
     ASSERT(gfx_family_idx != VK_QUEUE_FAMILY_IGNORED);
 
     VkDevice vk_device = create_vk_device(vk_instance, vk_phys_device, gfx_family_idx);
@@ -975,10 +1008,10 @@ int main(int argc, char** argv)
     u32 swapchain_image_count = 0;
     VK_CHECK(vkGetSwapchainImagesKHR(vk_device, vk_swapchain, &swapchain_image_count, nullptr));
 
-    Array<VkImage> swapchain_images = arena_push_array<VkImage>(ctx.bump, swapchain_image_count);
+    Array<VkImage> swapchain_images = arena_push_array<VkImage>(subsystem_bump(&ctx, Subsystem::RENDERER), swapchain_image_count);
     VK_CHECK(vkGetSwapchainImagesKHR(vk_device, vk_swapchain, &swapchain_image_count, swapchain_images.array));
 
-    Array<VkImageView> swapchain_image_views = arena_push_array<VkImageView>(ctx.bump, swapchain_image_count);
+    Array<VkImageView> swapchain_image_views = arena_push_array<VkImageView>(subsystem_bump(&ctx, Subsystem::RENDERER), swapchain_image_count);
     for (u32 i = 0; i < swapchain_image_count; ++i)
     {
         swapchain_image_views[i] = create_image_view(vk_device, swapchain_images[i], swapchain_fmt, VK_IMAGE_ASPECT_COLOR_BIT);    
@@ -988,7 +1021,7 @@ int main(int argc, char** argv)
 
     VkRenderPass vk_render_pass = create_vk_fullframe_renderpass(vk_device, swapchain_fmt, depth_buffer.fmt);
 
-    Array<VkFramebuffer> swapchain_framebuffers = arena_push_array<VkFramebuffer>(ctx.bump, swapchain_image_count);
+    Array<VkFramebuffer> swapchain_framebuffers = arena_push_array<VkFramebuffer>(subsystem_bump(&ctx, Subsystem::RENDERER), swapchain_image_count);
     for (u32 i = 0; i < swapchain_image_count; ++i)
     {
         VkImageView attachments[] = { swapchain_image_views[i], depth_buffer.view };
@@ -1031,17 +1064,32 @@ int main(int argc, char** argv)
         }
     }
 
-    shader_compiler_init();
-
-    char shader_path[MAX_PATH] = "\0";
-    strcpy(shader_path, root_dir);
-    strcat(shader_path, "src/shaders/basic.vert.glsl");
-    VkShaderModule vert_shader = compile_shader(vk_device, Shader_Stage::vertex, String{shader_path, MAX_PATH}, &ctx);
+    {
+        ARENA_DEFER_CLEAR(ctx.tmp_bump);
+        shader_compiler_init(path_join(ctx.tmp_bump, string_from_cstr(root_dir), STRING_LIT(".shader_cache")));
+    }
 
-    shader_path[0] = '\0';
-    strcpy(shader_path, root_dir);
-    strcat(shader_path, "src/shaders/triangle.frag.glsl");
-    VkShaderModule frag_shader = compile_shader(vk_device, Shader_Stage::fragment, String{shader_path, MAX_PATH}, &ctx);
+    VkShaderModule vert_shader = VK_NULL_HANDLE;
+    VkShaderModule frag_shader = VK_NULL_HANDLE;
+    {
+        ARENA_DEFER_CLEAR(ctx.tmp_bump);
+        String root_path = string_from_cstr(root_dir);
+
+        Shader_Compile_Request const requests[] = {
+            Shader_Compile_Request {
+                .stage = Shader_Stage::vertex,
+                .src_path = path_join(ctx.tmp_bump, root_path, STRING_LIT("src/shaders/basic.vert.glsl")),
+            },
+            Shader_Compile_Request {
+                .stage = Shader_Stage::fragment,
+                .src_path = path_join(ctx.tmp_bump, root_path, STRING_LIT("src/shaders/triangle.frag.glsl")),
+            },
+        };
+        VkShaderModule modules[ARRAYSIZE(requests)] = {};
+        compile_shaders(vk_device, Slice<Shader_Compile_Request>(requests), modules, &ctx);
+        vert_shader = modules[0];
+        frag_shader = modules[1];
+    }
 
     // TODO(): Configure later
     VkPipelineCache pipeline_cache = VK_NULL_HANDLE;
@@ -1068,8 +1116,8 @@ int main(int argc, char** argv)
         VkVertexInputBindingDescription vert_binds[Buffer_T::Vert_T_Cnt];
         vert_binds[Buffer_T::Pos].binding = Buffer_T::Pos;
         vert_binds[Buffer_T::Col].binding = Buffer_T::Col;
-        vert_binds[Buffer_T::Col].stride = sizeof(Vec3);
-        vert_binds[Buffer_T::Pos].stride = sizeof(Vec3);
+        vert_binds[Buffer_T::Col].stride = sizeof(Packed_Color);
+        vert_binds[Buffer_T::Pos].stride = sizeof(Packed_Position);
         vert_binds[Buffer_T::Pos].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
         vert_binds[Buffer_T::Col].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
@@ -1078,8 +1126,8 @@ int main(int argc, char** argv)
         vert_attrs[Buffer_T::Col].binding = Buffer_T::Col;
         vert_attrs[Buffer_T::Pos].location = Buffer_T::Pos;
         vert_attrs[Buffer_T::Col].location = Buffer_T::Col;
-        vert_attrs[Buffer_T::Pos].format = VK_FORMAT_R32G32B32_SFLOAT;
-        vert_attrs[Buffer_T::Col].format = VK_FORMAT_R32G32B32_SFLOAT;
+        vert_attrs[Buffer_T::Pos].format = VK_FORMAT_R16G16B16A16_SNORM;
+        vert_attrs[Buffer_T::Col].format = VK_FORMAT_R8G8B8A8_UNORM;
         vert_attrs[Buffer_T::Pos].offset = 0;
         vert_attrs[Buffer_T::Col].offset = 0;
 
@@ -1182,8 +1230,9 @@ int main(int argc, char** argv)
 
     vk_ctx.upload_ctx = create_upload_context(vk_device, gfx_family_idx);
 
-    Model cube_model;
-    Model cube_model_2;
+    Pool<Model> models = pool_create<Model>(subsystem_bump(&ctx, Subsystem::ASSETS), MAX_MODELS);
+    Pool_Handle<Model> cube_model;
+    Pool_Handle<Model> cube_model_2;
     {
         VkCommandBufferBeginInfo begin_info = {
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
@@ -1191,22 +1240,25 @@ int main(int argc, char** argv)
         };
 
         VK_CHECK(vkBeginCommandBuffer(vk_ctx.upload_ctx.cmd_buffer, &begin_info));
+        ARENA_DEFER_CLEAR(ctx.tmp_bump);
             
         Model_Upload model_upload = create_model(
             &vk_ctx,
+            ctx.tmp_bump,
             Slice<Vec3> { Cube_Geo::vertices },
             Slice<Vec3> { Cube_Geo::colors },
             Slice<u16>  { Cube_Geo::indices }
         );
-        cube_model = model_upload.model;
+        cube_model = pool_alloc(&models, model_upload.model);
 
         Model_Upload model_upload_2 = create_model(
             &vk_ctx,
+            ctx.tmp_bump,
             Slice<Vec3> { Cube_Geo::vertices },
             Slice<Vec3> { Cube_Geo::colors },
             Slice<u16>  { Cube_Geo::indices }
         );
-        cube_model_2 = model_upload_2.model;
+        cube_model_2 = pool_alloc(&models, model_upload_2.model);
 
         vkEndCommandBuffer(vk_ctx.upload_ctx.cmd_buffer);
 
@@ -1247,6 +1299,10 @@ int main(int argc, char** argv)
         vkWaitForFences(vk_device, 1, &end_of_frame_fences[frame_idx], VK_TRUE, max_timeout);
         vkResetFences(vk_device, 1, &end_of_frame_fences[frame_idx]);
 
+        // The GPU is done with everything this frame slot referenced last time around.
+        ctx.frame_bump = frame_arenas_begin(&frame_lifetime_allocators, frame_idx);
+        Mark frame_start_tmp_mark = arena_mark(ctx.tmp_bump);
+
         u32 img_idx = 0;
         VkResult get_next_img_result = vkAcquireNextImageKHR(vk_device, vk_swapchain, max_timeout, img_acq_semaphore[frame_idx], VK_NULL_HANDLE, &img_idx);
         VK_CHECK(get_next_img_result);
@@ -1362,39 +1418,59 @@ int main(int argc, char** argv)
 
         Vec3 cam_pos;
         {
-            f32 sin_azi = sinf(azi_zen_zoom.x);
-            f32 cos_azi = cosf(azi_zen_zoom.x);
-            f32 sin_zen = sinf(azi_zen_zoom.y);
-            f32 cos_zen = cosf(azi_zen_zoom.y);
+            Sin_Cos azi = sincos(azi_zen_zoom.x, Trig_Accuracy::LOW);
+            Sin_Cos zen = sincos(azi_zen_zoom.y, Trig_Accuracy::LOW);
             cam_pos = {
-                azi_zen_zoom.z * cos_zen * cos_azi,
-                azi_zen_zoom.z * sin_zen,
-                azi_zen_zoom.z * cos_zen * sin_azi,
+                azi_zen_zoom.z * zen.cos * azi.cos,
+                azi_zen_zoom.z * zen.sin,
+                azi_zen_zoom.z * zen.cos * azi.sin,
             };
         }
 
         Mat4 view = mat4_look_at(cam_pos, vec3_zero(), Vec3{0.f, 1.f, 0.f});
         
         Mat4 projection = mat4_perspective(degree_to_rad(70.f), f32(surface_width) / f32(surface_height), 0.1f, 200.f);
-        Mat4 model = mat4_identity();
-        Mat4 mesh_matrix = mat4_mul(projection, mat4_mul(view, model));
+        Mat4 view_projection = mat4_mul(projection, view);
+
+        Model const* const objects[] = { pool_get(&models, cube_model), pool_get(&models, cube_model_2) };
+        Mat4 const object_matrices[] = { mat4_identity(), mat4_translate(Vec3{0.f, 0.f, 2.f}) };
+        constexpr s64 num_objects = ARRAYSIZE(objects);
+
+        // World space bounding spheres, anything entirely outside the frustum isn't drawn.
+        f32 sphere_x[num_objects], sphere_y[num_objects], sphere_z[num_objects], sphere_radius[num_objects];
+        Mat4 model_matrices[num_objects];
+        for (s64 i = 0; i < num_objects; ++i)
+        {
+            Sphere sphere = sphere_transform(object_matrices[i], objects[i]->bounding_sphere);
+            sphere_x[i] = sphere.center.x;
+            sphere_y[i] = sphere.center.y;
+            sphere_z[i] = sphere.center.z;
+            sphere_radius[i] = sphere.radius;
+            model_matrices[i] = mat4_mul(object_matrices[i], objects[i]->dequantize);
+        }
 
-        VkDeviceSize buf_offsets[] = {0, 0};
-        VkBuffer vert_bufs[] = { cube_model.vertices.buffer, cube_model.colors.buffer };
-        vkCmdBindVertexBuffers(frame_cmds, 0, 2, vert_bufs, buf_offsets);
-        vkCmdBindIndexBuffer(frame_cmds, cube_model.indices.buffer, 0, VK_INDEX_TYPE_UINT16);
-        vkCmdPushConstants(frame_cmds, triangle_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Mat4), mesh_matrix.m);
-        vkCmdDrawIndexed(frame_cmds, cube_model.num_indices, 1, 0, 0, 0);
+        u32 visible[num_objects];
+        s64 num_visible = frustum_cull_spheres(frustum_from_matrix(view_projection), Sphere_Batch {
+            .center_x = sphere_x,
+            .center_y = sphere_y,
+            .center_z = sphere_z,
+            .radius = sphere_radius,
+            .count = num_objects,
+        }, visible, ctx.jobs);
 
-        model = mat4_translate(Vec3{0.f, 0.f, 2.f});
-        mesh_matrix = mat4_mul(projection, mat4_mul(view, model));
+        Mat4 mesh_matrices[num_objects];
+        mvp_batch_from_models(view_projection, Slice<Mat4>(model_matrices), mesh_matrices, ctx.jobs);
 
-        vert_bufs[0] = cube_model_2.vertices.buffer;
-        vert_bufs[1] = cube_model_2.colors.buffer;
-        vkCmdBindVertexBuffers(frame_cmds, 0, 2, vert_bufs, buf_offsets);
-        vkCmdBindIndexBuffer(frame_cmds, cube_model_2.indices.buffer, 0, VK_INDEX_TYPE_UINT16);
-        vkCmdPushConstants(frame_cmds, triangle_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Mat4), mesh_matrix.m);
-        vkCmdDrawIndexed(frame_cmds, cube_model_2.num_indices, 1, 0, 0, 0);
+        for (s64 i = 0; i < num_visible; ++i)
+        {
+            Model const* model = objects[visible[i]];
+            VkDeviceSize buf_offsets[] = {0, 0};
+            VkBuffer vert_bufs[] = { model->vertices.buffer, model->colors.buffer };
+            vkCmdBindVertexBuffers(frame_cmds, 0, 2, vert_bufs, buf_offsets);
+            vkCmdBindIndexBuffer(frame_cmds, model->indices.buffer, 0, VK_INDEX_TYPE_UINT16);
+            vkCmdPushConstants(frame_cmds, triangle_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Mat4), mesh_matrices[visible[i]].m);
+            vkCmdDrawIndexed(frame_cmds, model->num_indices, 1, 0, 0, 0);
+        }
 
 
         vkCmdEndRenderPass(frame_cmds);
@@ -1493,11 +1569,35 @@ int main(int argc, char** argv)
             }
         }
 
+        ASSERT_MSG(ctx.tmp_bump->bytes_allocated == frame_start_tmp_mark.position,
+                   "Leaked %lld bytes of temporary allocations during frame %lld. Use ctx.frame_bump for data that must outlive the frame.",
+                   s64(ctx.tmp_bump->bytes_allocated - frame_start_tmp_mark.position), frame_count);
+
+#if ARENA_TRACKING
+        {
+            Arena* tracked_arenas[] = { ctx.bump, ctx.tmp_bump, ctx.frame_bump };
+            char const* tracked_names[] = { "bump", "tmp_bump", "frame_bump" };
+            for (s64 i = 0; i < ARRAYSIZE(tracked_arenas); ++i)
+            {
+                Arena_Frame_Summary summary = arena_stats_end_frame(tracked_arenas[i]);
+                if (summary.is_new_high_water_mark)
+                {
+                    LOG("[Arena] %s reached a new high-water mark of %llu bytes in frame %lld (%llu pushes, %llu bytes this frame)",
+                        tracked_names[i], summary.peak_bytes_allocated, frame_count, summary.num_pushes, summary.bytes_pushed);
+                }
+            }
+        }
+#endif
+
         ++frame_count;
     }
 
     VK_CHECK(vkDeviceWaitIdle(vk_device));
 
+    arena_budget_dump(ctx.bump);
+    arena_stats_dump(ctx.bump, "bump");
+    arena_stats_dump(ctx.tmp_bump, "tmp_bump");
+
     shader_compiler_shutdown();
 
     vkDestroyShaderModule(vk_device, vert_shader, nullptr);
@@ -1518,7 +1618,10 @@ int main(int argc, char** argv)
     vkDestroyRenderPass(vk_device, vk_render_pass, nullptr);
     vkDestroyCommandPool(vk_device, gfx_cmd_pool, nullptr); // destroying the command pool also destroys its commandbuffers.
     
-    destroy_model(&vk_ctx, &cube_model);
+    for (Model& model : models)
+    {
+        destroy_model(&vk_ctx, &model);
+    }
 
     destroy_upload_context(vk_device, vk_ctx.upload_ctx);
 
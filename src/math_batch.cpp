@@ -0,0 +1,948 @@
+#include "math_batch.h"
+#include "jobs.h"
+
+static_assert(sizeof(Vec3) == 3 * sizeof(f32), "lanes_load_xyz reads Vec3 arrays as packed floats.");
+
+#if MATH_SSE
+// Splits 4 packed Vec3s, loaded as x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3, into one register per component.
+static inline void sse_load_xyz(Vec3 const* p, __m128* x, __m128* y, __m128* z)
+{
+    __m128 a = _mm_loadu_ps(&p->x);
+    __m128 b = _mm_loadu_ps(&p->x + 4);
+    __m128 c = _mm_loadu_ps(&p->x + 8);
+    *x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 1, 3, 0));
+    *y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    *z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+}
+#endif
+
+// Lanes hold the same value for C_LANES different objects.
+#if MATH_AVX && defined(__AVX2__) && defined(__FMA__)
+using Lanes = __m256;
+constexpr s64 C_LANES = 8;
+static inline Lanes lanes_load(f32 const* p) { return _mm256_loadu_ps(p); }
+static inline Lanes lanes_set(f32 v) { return _mm256_set1_ps(v); }
+static inline Lanes lanes_add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+static inline Lanes lanes_sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+static inline Lanes lanes_mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+static inline Lanes lanes_madd(Lanes a, Lanes b, Lanes c) { return _mm256_fmadd_ps(a, b, c); }
+static inline void lanes_store(f32* p, Lanes v) { _mm256_storeu_ps(p, v); }
+static inline Lanes lanes_min(Lanes a, Lanes b) { return _mm256_min_ps(a, b); }
+static inline Lanes lanes_max(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+
+using Lanes_Mask = __m256;
+static inline Lanes_Mask lanes_greater(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+static inline Lanes lanes_select(Lanes_Mask mask, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, mask); }
+static inline bool lanes_any(Lanes_Mask mask) { return _mm256_movemask_ps(mask) != 0; }
+static inline u32 lanes_mask_bits(Lanes_Mask mask) { return u32(_mm256_movemask_ps(mask)); }
+
+static inline void lanes_load_xyz(Vec3 const* p, Lanes* x, Lanes* y, Lanes* z)
+{
+    __m128 x_lo, y_lo, z_lo, x_hi, y_hi, z_hi;
+    sse_load_xyz(p, &x_lo, &y_lo, &z_lo);
+    sse_load_xyz(p + 4, &x_hi, &y_hi, &z_hi);
+    *x = _mm256_insertf128_ps(_mm256_castps128_ps256(x_lo), x_hi, 1);
+    *y = _mm256_insertf128_ps(_mm256_castps128_ps256(y_lo), y_hi, 1);
+    *z = _mm256_insertf128_ps(_mm256_castps128_ps256(z_lo), z_hi, 1);
+}
+
+using Lanes_Int = __m256i;
+static inline Lanes_Int lanes_round_to_int(Lanes v) { return _mm256_cvtps_epi32(v); }
+static inline Lanes lanes_from_int(Lanes_Int v) { return _mm256_cvtepi32_ps(v); }
+
+// Moves sin(r) and cos(r) into the quadrant j, see detail::sincos_poly.
+static inline void lanes_sincos_quadrant(Lanes_Int j, Lanes* sin_r, Lanes* cos_r)
+{
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i two = _mm256_set1_epi32(2);
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(j, one), one));
+    __m256 s = _mm256_blendv_ps(*sin_r, *cos_r, swap);
+    __m256 c = _mm256_blendv_ps(*cos_r, *sin_r, swap);
+    __m256i sin_sign = _mm256_slli_epi32(_mm256_and_si256(j, two), 30);
+    __m256i cos_sign = _mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(j, one), two), 30);
+    *sin_r = _mm256_xor_ps(s, _mm256_castsi256_ps(sin_sign));
+    *cos_r = _mm256_xor_ps(c, _mm256_castsi256_ps(cos_sign));
+}
+
+// Transposes v as two independent 4x4 blocks, one per 128-bit half.
+static inline void lanes_transpose4(Lanes v[4])
+{
+    __m256 t0 = _mm256_unpacklo_ps(v[0], v[1]);
+    __m256 t1 = _mm256_unpackhi_ps(v[0], v[1]);
+    __m256 t2 = _mm256_unpacklo_ps(v[2], v[3]);
+    __m256 t3 = _mm256_unpackhi_ps(v[2], v[3]);
+    v[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    v[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    v[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    v[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// rows[r] holds row r of column c for every object. Transposes them and writes column c of
+// each object's matrix, objects 0-3 come from the low halves and 4-7 from the high halves.
+static inline void lanes_store_column(Lanes const rows[4], Mat4* out, u32 c)
+{
+    __m256 cols[4] = { rows[0], rows[1], rows[2], rows[3] };
+    lanes_transpose4(cols);
+    _mm_store_ps(&out[0].m[4 * c], _mm256_castps256_ps128(cols[0]));
+    _mm_store_ps(&out[1].m[4 * c], _mm256_castps256_ps128(cols[1]));
+    _mm_store_ps(&out[2].m[4 * c], _mm256_castps256_ps128(cols[2]));
+    _mm_store_ps(&out[3].m[4 * c], _mm256_castps256_ps128(cols[3]));
+    _mm_store_ps(&out[4].m[4 * c], _mm256_extractf128_ps(cols[0], 1));
+    _mm_store_ps(&out[5].m[4 * c], _mm256_extractf128_ps(cols[1], 1));
+    _mm_store_ps(&out[6].m[4 * c], _mm256_extractf128_ps(cols[2], 1));
+    _mm_store_ps(&out[7].m[4 * c], _mm256_extractf128_ps(cols[3], 1));
+}
+
+static inline __m256 load_column_pair(Mat4 const* lo, Mat4 const* hi, u32 c)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_load_ps(&lo->m[4 * c])), _mm_load_ps(&hi->m[4 * c]), 1);
+}
+
+// The inverse of lanes_store_column: column c of C_LANES matrices into one row per register.
+static inline void lanes_load_column(Mat4 const* in, u32 c, Lanes rows[4])
+{
+    rows[0] = load_column_pair(&in[0], &in[4], c);
+    rows[1] = load_column_pair(&in[1], &in[5], c);
+    rows[2] = load_column_pair(&in[2], &in[6], c);
+    rows[3] = load_column_pair(&in[3], &in[7], c);
+    lanes_transpose4(rows);
+}
+#elif MATH_SSE
+using Lanes = __m128;
+constexpr s64 C_LANES = 4;
+static inline Lanes lanes_load(f32 const* p) { return _mm_loadu_ps(p); }
+static inline Lanes lanes_set(f32 v) { return _mm_set1_ps(v); }
+static inline Lanes lanes_add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+static inline Lanes lanes_sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+static inline Lanes lanes_mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+static inline Lanes lanes_madd(Lanes a, Lanes b, Lanes c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+static inline void lanes_store(f32* p, Lanes v) { _mm_storeu_ps(p, v); }
+static inline Lanes lanes_min(Lanes a, Lanes b) { return _mm_min_ps(a, b); }
+static inline Lanes lanes_max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+
+using Lanes_Mask = __m128;
+static inline Lanes_Mask lanes_greater(Lanes a, Lanes b) { return _mm_cmpgt_ps(a, b); }
+static inline Lanes lanes_select(Lanes_Mask mask, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline bool lanes_any(Lanes_Mask mask) { return _mm_movemask_ps(mask) != 0; }
+static inline u32 lanes_mask_bits(Lanes_Mask mask) { return u32(_mm_movemask_ps(mask)); }
+static inline void lanes_load_xyz(Vec3 const* p, Lanes* x, Lanes* y, Lanes* z) { sse_load_xyz(p, x, y, z); }
+
+using Lanes_Int = __m128i;
+static inline Lanes_Int lanes_round_to_int(Lanes v) { return _mm_cvtps_epi32(v); }
+static inline Lanes lanes_from_int(Lanes_Int v) { return _mm_cvtepi32_ps(v); }
+
+static inline void lanes_sincos_quadrant(Lanes_Int j, Lanes* sin_r, Lanes* cos_r)
+{
+    __m128i one = _mm_set1_epi32(1);
+    __m128i two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, one), one));
+    __m128 s = _mm_or_ps(_mm_and_ps(swap, *cos_r), _mm_andnot_ps(swap, *sin_r));
+    __m128 c = _mm_or_ps(_mm_and_ps(swap, *sin_r), _mm_andnot_ps(swap, *cos_r));
+    __m128i sin_sign = _mm_slli_epi32(_mm_and_si128(j, two), 30);
+    __m128i cos_sign = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(j, one), two), 30);
+    *sin_r = _mm_xor_ps(s, _mm_castsi128_ps(sin_sign));
+    *cos_r = _mm_xor_ps(c, _mm_castsi128_ps(cos_sign));
+}
+
+static inline void lanes_store_column(Lanes const rows[4], Mat4* out, u32 c)
+{
+    __m128 r0 = rows[0], r1 = rows[1], r2 = rows[2], r3 = rows[3];
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_store_ps(&out[0].m[4 * c], r0);
+    _mm_store_ps(&out[1].m[4 * c], r1);
+    _mm_store_ps(&out[2].m[4 * c], r2);
+    _mm_store_ps(&out[3].m[4 * c], r3);
+}
+
+static inline void lanes_load_column(Mat4 const* in, u32 c, Lanes rows[4])
+{
+    __m128 r0 = _mm_load_ps(&in[0].m[4 * c]);
+    __m128 r1 = _mm_load_ps(&in[1].m[4 * c]);
+    __m128 r2 = _mm_load_ps(&in[2].m[4 * c]);
+    __m128 r3 = _mm_load_ps(&in[3].m[4 * c]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    rows[0] = r0;
+    rows[1] = r1;
+    rows[2] = r2;
+    rows[3] = r3;
+}
+#elif MATH_NEON
+using Lanes = float32x4_t;
+constexpr s64 C_LANES = 4;
+static inline Lanes lanes_load(f32 const* p) { return vld1q_f32(p); }
+static inline Lanes lanes_set(f32 v) { return vdupq_n_f32(v); }
+static inline Lanes lanes_add(Lanes a, Lanes b) { return vaddq_f32(a, b); }
+static inline Lanes lanes_sub(Lanes a, Lanes b) { return vsubq_f32(a, b); }
+static inline Lanes lanes_mul(Lanes a, Lanes b) { return vmulq_f32(a, b); }
+static inline Lanes lanes_madd(Lanes a, Lanes b, Lanes c) { return vfmaq_f32(c, a, b); }
+static inline void lanes_store(f32* p, Lanes v) { vst1q_f32(p, v); }
+static inline Lanes lanes_min(Lanes a, Lanes b) { return vminq_f32(a, b); }
+static inline Lanes lanes_max(Lanes a, Lanes b) { return vmaxq_f32(a, b); }
+
+using Lanes_Mask = uint32x4_t;
+static inline Lanes_Mask lanes_greater(Lanes a, Lanes b) { return vcgtq_f32(a, b); }
+static inline Lanes lanes_select(Lanes_Mask mask, Lanes a, Lanes b) { return vbslq_f32(mask, a, b); }
+static inline bool lanes_any(Lanes_Mask mask) { return vmaxvq_u32(mask) != 0; }
+
+static inline u32 lanes_mask_bits(Lanes_Mask mask)
+{
+    uint32x4_t const bits = { 1, 2, 4, 8 };
+    return vaddvq_u32(vandq_u32(mask, bits));
+}
+
+// vld3 deinterleaves 4 Vec3s into one register per component.
+static inline void lanes_load_xyz(Vec3 const* p, Lanes* x, Lanes* y, Lanes* z)
+{
+    float32x4x3_t xyz = vld3q_f32(&p->x);
+    *x = xyz.val[0];
+    *y = xyz.val[1];
+    *z = xyz.val[2];
+}
+
+using Lanes_Int = int32x4_t;
+static inline Lanes_Int lanes_round_to_int(Lanes v) { return vcvtnq_s32_f32(v); }
+static inline Lanes lanes_from_int(Lanes_Int v) { return vcvtq_f32_s32(v); }
+
+static inline void lanes_sincos_quadrant(Lanes_Int j, Lanes* sin_r, Lanes* cos_r)
+{
+    int32x4_t one = vdupq_n_s32(1);
+    int32x4_t two = vdupq_n_s32(2);
+    uint32x4_t swap = vtstq_s32(j, one);
+    float32x4_t s = vbslq_f32(swap, *cos_r, *sin_r);
+    float32x4_t c = vbslq_f32(swap, *sin_r, *cos_r);
+    uint32x4_t sin_sign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(j, two), 30));
+    uint32x4_t cos_sign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(vaddq_s32(j, one), two), 30));
+    *sin_r = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(s), sin_sign));
+    *cos_r = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(c), cos_sign));
+}
+
+static inline void lanes_transpose4(Lanes v[4])
+{
+    float32x4x2_t t0 = vtrnq_f32(v[0], v[1]);
+    float32x4x2_t t1 = vtrnq_f32(v[2], v[3]);
+    v[0] = vcombine_f32(vget_low_f32(t0.val[0]), vget_low_f32(t1.val[0]));
+    v[1] = vcombine_f32(vget_low_f32(t0.val[1]), vget_low_f32(t1.val[1]));
+    v[2] = vcombine_f32(vget_high_f32(t0.val[0]), vget_high_f32(t1.val[0]));
+    v[3] = vcombine_f32(vget_high_f32(t0.val[1]), vget_high_f32(t1.val[1]));
+}
+
+static inline void lanes_store_column(Lanes const rows[4], Mat4* out, u32 c)
+{
+    float32x4_t cols[4] = { rows[0], rows[1], rows[2], rows[3] };
+    lanes_transpose4(cols);
+    vst1q_f32(&out[0].m[4 * c], cols[0]);
+    vst1q_f32(&out[1].m[4 * c], cols[1]);
+    vst1q_f32(&out[2].m[4 * c], cols[2]);
+    vst1q_f32(&out[3].m[4 * c], cols[3]);
+}
+
+static inline void lanes_load_column(Mat4 const* in, u32 c, Lanes rows[4])
+{
+    rows[0] = vld1q_f32(&in[0].m[4 * c]);
+    rows[1] = vld1q_f32(&in[1].m[4 * c]);
+    rows[2] = vld1q_f32(&in[2].m[4 * c]);
+    rows[3] = vld1q_f32(&in[3].m[4 * c]);
+    lanes_transpose4(rows);
+}
+#else
+using Lanes = f32;
+constexpr s64 C_LANES = 1;
+static inline Lanes lanes_load(f32 const* p) { return *p; }
+static inline Lanes lanes_set(f32 v) { return v; }
+static inline Lanes lanes_add(Lanes a, Lanes b) { return a + b; }
+static inline Lanes lanes_sub(Lanes a, Lanes b) { return a - b; }
+static inline Lanes lanes_mul(Lanes a, Lanes b) { return a * b; }
+static inline Lanes lanes_madd(Lanes a, Lanes b, Lanes c) { return a * b + c; }
+static inline void lanes_store(f32* p, Lanes v) { *p = v; }
+static inline Lanes lanes_min(Lanes a, Lanes b) { return a < b ? a : b; }
+static inline Lanes lanes_max(Lanes a, Lanes b) { return a > b ? a : b; }
+
+using Lanes_Mask = bool;
+static inline Lanes_Mask lanes_greater(Lanes a, Lanes b) { return a > b; }
+static inline Lanes lanes_select(Lanes_Mask mask, Lanes a, Lanes b) { return mask ? a : b; }
+static inline bool lanes_any(Lanes_Mask mask) { return mask; }
+static inline u32 lanes_mask_bits(Lanes_Mask mask) { return mask ? 1 : 0; }
+
+static inline void lanes_load_xyz(Vec3 const* p, Lanes* x, Lanes* y, Lanes* z)
+{
+    *x = p->x;
+    *y = p->y;
+    *z = p->z;
+}
+
+using Lanes_Int = s32;
+static inline Lanes_Int lanes_round_to_int(Lanes v) { return s32(v >= 0.0f ? v + 0.5f : v - 0.5f); }
+static inline Lanes lanes_from_int(Lanes_Int v) { return f32(v); }
+
+static inline void lanes_sincos_quadrant(Lanes_Int j, Lanes* sin_r, Lanes* cos_r)
+{
+    f32 s = (j & 1) ? *cos_r : *sin_r;
+    f32 c = (j & 1) ? *sin_r : *cos_r;
+    *sin_r = (j & 2) ? -s : s;
+    *cos_r = ((j + 1) & 2) ? -c : c;
+}
+
+static inline void lanes_store_column(Lanes const rows[4], Mat4* out, u32 c)
+{
+    for (u32 r = 0; r < 4; ++r)
+    {
+        out->m[4 * c + r] = rows[r];
+    }
+}
+
+static inline void lanes_load_column(Mat4 const* in, u32 c, Lanes rows[4])
+{
+    for (u32 r = 0; r < 4; ++r)
+    {
+        rows[r] = in->m[4 * c + r];
+    }
+}
+#endif
+
+static Mat4 model_from_trs(TRS_Batch const& trs, s64 i)
+{
+    Transform t;
+    t.translation = Vec3{ trs.pos_x[i], trs.pos_y[i], trs.pos_z[i] };
+    t.rotation = Quat{ trs.rot_x[i], trs.rot_y[i], trs.rot_z[i], trs.rot_w[i] };
+    t.scale = Vec3{ trs.scale_x[i], trs.scale_y[i], trs.scale_z[i] };
+    return mat4_from_transform(t);
+}
+
+// vp[r][k] is vp(r, k) in every lane, set up once per range instead of once per C_LANES objects.
+static void broadcast_mat4(Mat4 const& m, Lanes out[4][4])
+{
+    for (u32 r = 0; r < 4; ++r)
+    {
+        for (u32 k = 0; k < 4; ++k)
+        {
+            out[r][k] = lanes_set(m(r, k));
+        }
+    }
+}
+
+// Row r of column c of mvp for C_LANES objects: mvp(r, c) = sum_k vp(r, k) * model(k, c),
+// where model_column[k] holds model(k, c) of every object and vp_row[k] holds vp(r, k).
+// Affine models skip the fourth row, which is always (0, 0, 0, 1) and doesn't need to be set.
+template <bool affine>
+static inline Lanes mvp_lanes(Lanes const vp_row[4], Lanes const model_column[4], u32 c)
+{
+    Lanes acc;
+    if (affine)
+    {
+        acc = (c == 3) ? vp_row[3] : lanes_set(0.f);
+    }
+    else
+    {
+        acc = lanes_mul(vp_row[3], model_column[3]);
+    }
+    acc = lanes_madd(vp_row[0], model_column[0], acc);
+    acc = lanes_madd(vp_row[1], model_column[1], acc);
+    return lanes_madd(vp_row[2], model_column[2], acc);
+}
+
+// Written out rather than looped over rows, so compilers that don't fully unroll short loops
+// at -O2 still keep everything in registers.
+template <bool affine>
+static inline void mvp_store_column_lanes(Lanes const vp[4][4], Lanes const model_column[4], Mat4* out_mvps, u32 c)
+{
+    Lanes rows[4] = {
+        mvp_lanes<affine>(vp[0], model_column, c),
+        mvp_lanes<affine>(vp[1], model_column, c),
+        mvp_lanes<affine>(vp[2], model_column, c),
+        mvp_lanes<affine>(vp[3], model_column, c),
+    };
+    lanes_store_column(rows, out_mvps, c);
+}
+
+// Same math as mat4_from_transform followed by mat4_mul(view_projection, model), for C_LANES objects starting at `first`.
+static void mvp_from_trs_lanes(Lanes const vp[4][4], TRS_Batch const& trs, s64 first, Mat4* out_mvps)
+{
+    Lanes x = lanes_load(trs.rot_x + first);
+    Lanes y = lanes_load(trs.rot_y + first);
+    Lanes z = lanes_load(trs.rot_z + first);
+    Lanes w = lanes_load(trs.rot_w + first);
+
+    Lanes two = lanes_set(2.f);
+    Lanes one = lanes_set(1.f);
+    Lanes x2 = lanes_mul(x, two);
+    Lanes y2 = lanes_mul(y, two);
+    Lanes z2 = lanes_mul(z, two);
+    Lanes xx = lanes_mul(x, x2), yy = lanes_mul(y, y2), zz = lanes_mul(z, z2);
+    Lanes xy = lanes_mul(x, y2), xz = lanes_mul(x, z2), yz = lanes_mul(y, z2);
+    Lanes wx = lanes_mul(w, x2), wy = lanes_mul(w, y2), wz = lanes_mul(w, z2);
+
+    // model[c][r]: column c, row r of the model matrix. The fourth row is always (0, 0, 0, 1).
+    Lanes model[4][4];
+    Lanes sx = lanes_load(trs.scale_x + first);
+    Lanes sy = lanes_load(trs.scale_y + first);
+    Lanes sz = lanes_load(trs.scale_z + first);
+    model[0][0] = lanes_mul(lanes_sub(one, lanes_add(yy, zz)), sx);
+    model[0][1] = lanes_mul(lanes_add(xy, wz), sx);
+    model[0][2] = lanes_mul(lanes_sub(xz, wy), sx);
+    model[1][0] = lanes_mul(lanes_sub(xy, wz), sy);
+    model[1][1] = lanes_mul(lanes_sub(one, lanes_add(xx, zz)), sy);
+    model[1][2] = lanes_mul(lanes_add(yz, wx), sy);
+    model[2][0] = lanes_mul(lanes_add(xz, wy), sz);
+    model[2][1] = lanes_mul(lanes_sub(yz, wx), sz);
+    model[2][2] = lanes_mul(lanes_sub(one, lanes_add(xx, yy)), sz);
+    model[3][0] = lanes_load(trs.pos_x + first);
+    model[3][1] = lanes_load(trs.pos_y + first);
+    model[3][2] = lanes_load(trs.pos_z + first);
+
+    mvp_store_column_lanes<true>(vp, model[0], out_mvps + first, 0);
+    mvp_store_column_lanes<true>(vp, model[1], out_mvps + first, 1);
+    mvp_store_column_lanes<true>(vp, model[2], out_mvps + first, 2);
+    mvp_store_column_lanes<true>(vp, model[3], out_mvps + first, 3);
+}
+
+// mat4_mul(view_projection, models[i]) for C_LANES objects starting at `first`, with the
+// models transposed into lanes so the product runs across objects like the TRS version.
+// Column c of the result only needs column c of the models, so one is loaded at a time and
+// the broadcast view-projection can stay in registers.
+static void mvp_from_models_lanes(Lanes const vp[4][4], Mat4 const* models, s64 first, Mat4* out_mvps)
+{
+    Lanes model_column[4];
+    lanes_load_column(models + first, 0, model_column);
+    mvp_store_column_lanes<false>(vp, model_column, out_mvps + first, 0);
+    lanes_load_column(models + first, 1, model_column);
+    mvp_store_column_lanes<false>(vp, model_column, out_mvps + first, 1);
+    lanes_load_column(models + first, 2, model_column);
+    mvp_store_column_lanes<false>(vp, model_column, out_mvps + first, 2);
+    lanes_load_column(models + first, 3, model_column);
+    mvp_store_column_lanes<false>(vp, model_column, out_mvps + first, 3);
+}
+
+// Same math as detail::sincos_poly, for C_LANES values starting at `first`.
+template <bool high>
+static void sincos_lanes(f32 const* x, f32* out_sin, f32* out_cos, s64 first)
+{
+    Lanes v = lanes_load(x + first);
+    Lanes_Int j = lanes_round_to_int(lanes_mul(v, lanes_set(detail::C_TWO_OVER_PI)));
+    Lanes jf = lanes_from_int(j);
+    Lanes r = lanes_madd(jf, lanes_set(-detail::C_HALF_PI_1), v);
+    r = lanes_madd(jf, lanes_set(-detail::C_HALF_PI_2), r);
+    r = lanes_madd(jf, lanes_set(-detail::C_HALF_PI_3), r);
+    Lanes r2 = lanes_mul(r, r);
+    Lanes r3 = lanes_mul(r2, r);
+    Lanes r4 = lanes_mul(r2, r2);
+
+    Lanes sin_r;
+    Lanes cos_r;
+    if constexpr (high)
+    {
+        Lanes sin_poly = lanes_madd(r2, lanes_set(detail::C_SIN_HIGH_3), lanes_set(detail::C_SIN_HIGH_2));
+        sin_poly = lanes_madd(r2, sin_poly, lanes_set(detail::C_SIN_HIGH_1));
+        sin_r = lanes_madd(r3, sin_poly, r);
+
+        Lanes cos_poly = lanes_madd(r2, lanes_set(detail::C_COS_HIGH_3), lanes_set(detail::C_COS_HIGH_2));
+        cos_poly = lanes_madd(r2, cos_poly, lanes_set(detail::C_COS_HIGH_1));
+        cos_r = lanes_madd(r4, cos_poly, lanes_madd(r2, lanes_set(-0.5f), lanes_set(1.0f)));
+    }
+    else
+    {
+        sin_r = lanes_madd(r3, lanes_madd(r2, lanes_set(detail::C_SIN_LOW_2), lanes_set(detail::C_SIN_LOW_1)), r);
+        cos_r = lanes_madd(r2, lanes_madd(r2, lanes_set(detail::C_COS_LOW_2), lanes_set(detail::C_COS_LOW_1)), lanes_set(1.0f));
+    }
+
+    lanes_sincos_quadrant(j, &sin_r, &cos_r);
+    lanes_store(out_sin + first, sin_r);
+    lanes_store(out_cos + first, cos_r);
+}
+
+struct Sincos_Batch_Job
+{
+    f32 const* x = nullptr;
+    f32* out_sin = nullptr;
+    f32* out_cos = nullptr;
+    Trig_Accuracy accuracy = Trig_Accuracy::LIBM;
+};
+
+template <bool high>
+static void sincos_poly_range(Sincos_Batch_Job const* job, s64 begin, s64 end)
+{
+    s64 i = begin;
+    for (; i + C_LANES <= end; i += C_LANES)
+    {
+        sincos_lanes<high>(job->x, job->out_sin, job->out_cos, i);
+    }
+    for (; i < end; ++i)
+    {
+        Sin_Cos sc = sincos(job->x[i], job->accuracy);
+        job->out_sin[i] = sc.sin;
+        job->out_cos[i] = sc.cos;
+    }
+}
+
+static void sincos_range(void* user, s64 begin, s64 end)
+{
+    Sincos_Batch_Job const* job = (Sincos_Batch_Job const*)user;
+    switch (job->accuracy)
+    {
+    case Trig_Accuracy::HIGH: sincos_poly_range<true>(job, begin, end); break;
+    case Trig_Accuracy::LOW: sincos_poly_range<false>(job, begin, end); break;
+    case Trig_Accuracy::LIBM:
+        for (s64 i = begin; i < end; ++i)
+        {
+            Sin_Cos sc = sincos(job->x[i]);
+            job->out_sin[i] = sc.sin;
+            job->out_cos[i] = sc.cos;
+        }
+        break;
+    }
+}
+
+struct MVP_Batch_Job
+{
+    Mat4 const* view_projection = nullptr;
+    TRS_Batch const* trs = nullptr;
+    Mat4 const* models = nullptr;
+    Mat4* out_mvps = nullptr;
+};
+
+static void mvp_from_trs_range(void* user, s64 begin, s64 end)
+{
+    MVP_Batch_Job const* job = (MVP_Batch_Job const*)user;
+    Lanes vp[4][4];
+    broadcast_mat4(*job->view_projection, vp);
+
+    s64 i = begin;
+    for (; i + C_LANES <= end; i += C_LANES)
+    {
+        mvp_from_trs_lanes(vp, *job->trs, i, job->out_mvps);
+    }
+    for (; i < end; ++i)
+    {
+        job->out_mvps[i] = mat4_mul(*job->view_projection, model_from_trs(*job->trs, i));
+    }
+}
+
+static void mvp_from_models_range(void* user, s64 begin, s64 end)
+{
+    MVP_Batch_Job const* job = (MVP_Batch_Job const*)user;
+    Lanes vp[4][4];
+    broadcast_mat4(*job->view_projection, vp);
+
+    s64 i = begin;
+    for (; i + C_LANES <= end; i += C_LANES)
+    {
+        mvp_from_models_lanes(vp, job->models, i, job->out_mvps);
+    }
+    for (; i < end; ++i)
+    {
+        job->out_mvps[i] = mat4_mul(*job->view_projection, job->models[i]);
+    }
+}
+
+void mvp_batch_from_trs(Mat4 const& view_projection, TRS_Batch const& trs, Mat4* out_mvps, Job_System* jobs)
+{
+    MVP_Batch_Job job;
+    job.view_projection = &view_projection;
+    job.trs = &trs;
+    job.out_mvps = out_mvps;
+
+    // Batches are multiples of C_LANES, so only the very last one has a scalar tail.
+    job_parallel_for(jobs, trs.count, C_MVP_BATCH_JOB_SIZE, mvp_from_trs_range, &job);
+}
+
+void mvp_batch_from_models(Mat4 const& view_projection, Slice<Mat4> models, Mat4* out_mvps, Job_System* jobs)
+{
+    MVP_Batch_Job job;
+    job.view_projection = &view_projection;
+    job.models = models.array;
+    job.out_mvps = out_mvps;
+
+    job_parallel_for(jobs, models.count, C_MVP_BATCH_JOB_SIZE, mvp_from_models_range, &job);
+}
+
+void sincos_batch(f32 const* x, f32* out_sin, f32* out_cos, s64 count, Trig_Accuracy accuracy, Job_System* jobs)
+{
+    Sincos_Batch_Job job;
+    job.x = x;
+    job.out_sin = out_sin;
+    job.out_cos = out_cos;
+    job.accuracy = accuracy;
+
+    job_parallel_for(jobs, count, C_SINCOS_BATCH_JOB_SIZE, sincos_range, &job);
+}
+
+// Bounds kernels read points through these, so one version of each handles both layouts.
+static inline void load_points(Slice<Vec3> const& points, s64 first, Lanes* x, Lanes* y, Lanes* z)
+{
+    lanes_load_xyz(points.array + first, x, y, z);
+}
+
+static inline void load_points(Points_SoA const& points, s64 first, Lanes* x, Lanes* y, Lanes* z)
+{
+    *x = lanes_load(points.x + first);
+    *y = lanes_load(points.y + first);
+    *z = lanes_load(points.z + first);
+}
+
+static inline Vec3 point_at(Slice<Vec3> const& points, s64 i)
+{
+    return points.array[i];
+}
+
+static inline Vec3 point_at(Points_SoA const& points, s64 i)
+{
+    return Vec3{ points.x[i], points.y[i], points.z[i] };
+}
+
+static inline Lanes lanes_dist_sq(Lanes x, Lanes y, Lanes z, Vec3 p)
+{
+    Lanes dx = lanes_sub(x, lanes_set(p.x));
+    Lanes dy = lanes_sub(y, lanes_set(p.y));
+    Lanes dz = lanes_sub(z, lanes_set(p.z));
+    return lanes_madd(dx, dx, lanes_madd(dy, dy, lanes_mul(dz, dz)));
+}
+
+template <typename Points>
+static AABB aabb_from_points_lanes(Points const& points)
+{
+    AABB box;
+    Lanes min_x = lanes_set(box.min.x), min_y = lanes_set(box.min.y), min_z = lanes_set(box.min.z);
+    Lanes max_x = lanes_set(box.max.x), max_y = lanes_set(box.max.y), max_z = lanes_set(box.max.z);
+
+    s64 i = 0;
+    for (; i + C_LANES <= points.count; i += C_LANES)
+    {
+        Lanes x, y, z;
+        load_points(points, i, &x, &y, &z);
+        min_x = lanes_min(min_x, x);
+        min_y = lanes_min(min_y, y);
+        min_z = lanes_min(min_z, z);
+        max_x = lanes_max(max_x, x);
+        max_y = lanes_max(max_y, y);
+        max_z = lanes_max(max_z, z);
+    }
+
+    // Adding both corners of every lane's box merges them, but only once a lane has seen a point.
+    if (i > 0)
+    {
+        f32 lo[3][C_LANES];
+        f32 hi[3][C_LANES];
+        lanes_store(lo[0], min_x);
+        lanes_store(lo[1], min_y);
+        lanes_store(lo[2], min_z);
+        lanes_store(hi[0], max_x);
+        lanes_store(hi[1], max_y);
+        lanes_store(hi[2], max_z);
+        for (s64 k = 0; k < C_LANES; ++k)
+        {
+            box = aabb_add(box, Vec3{ lo[0][k], lo[1][k], lo[2][k] });
+            box = aabb_add(box, Vec3{ hi[0][k], hi[1][k], hi[2][k] });
+        }
+    }
+
+    for (; i < points.count; ++i)
+    {
+        box = aabb_add(box, point_at(points, i));
+    }
+    return box;
+}
+
+// Every lane keeps the farthest point it has seen, the lanes are compared at the end.
+template <typename Points>
+static Vec3 farthest_point(Points const& points, Vec3 from)
+{
+    Lanes best_dist_sq = lanes_set(-1.0f);
+    Lanes best_x = lanes_set(from.x), best_y = lanes_set(from.y), best_z = lanes_set(from.z);
+
+    s64 i = 0;
+    for (; i + C_LANES <= points.count; i += C_LANES)
+    {
+        Lanes x, y, z;
+        load_points(points, i, &x, &y, &z);
+        Lanes dist_sq = lanes_dist_sq(x, y, z, from);
+        Lanes_Mask farther = lanes_greater(dist_sq, best_dist_sq);
+        best_dist_sq = lanes_select(farther, dist_sq, best_dist_sq);
+        best_x = lanes_select(farther, x, best_x);
+        best_y = lanes_select(farther, y, best_y);
+        best_z = lanes_select(farther, z, best_z);
+    }
+
+    f32 dist_sq[C_LANES];
+    f32 xyz[3][C_LANES];
+    lanes_store(dist_sq, best_dist_sq);
+    lanes_store(xyz[0], best_x);
+    lanes_store(xyz[1], best_y);
+    lanes_store(xyz[2], best_z);
+
+    f32 max_dist_sq = -1.0f;
+    Vec3 result = from;
+    for (s64 k = 0; k < C_LANES; ++k)
+    {
+        if (dist_sq[k] > max_dist_sq)
+        {
+            max_dist_sq = dist_sq[k];
+            result = Vec3{ xyz[0][k], xyz[1][k], xyz[2][k] };
+        }
+    }
+
+    for (; i < points.count; ++i)
+    {
+        Vec3 p = point_at(points, i);
+        Vec3 d = p - from;
+        if (dot(d, d) > max_dist_sq)
+        {
+            max_dist_sq = dot(d, d);
+            result = p;
+        }
+    }
+    return result;
+}
+
+// One pass of sphere_add over all points. Once the sphere has settled almost every point is
+// inside it, so C_LANES points are tested at once and only a group with a point outside
+// goes through the sequential growth steps.
+template <typename Points>
+static Sphere sphere_grow(Points const& points, Sphere s)
+{
+    s64 i = 0;
+    for (; i + C_LANES <= points.count; i += C_LANES)
+    {
+        Lanes x, y, z;
+        load_points(points, i, &x, &y, &z);
+        Lanes dist_sq = lanes_dist_sq(x, y, z, s.center);
+        if (!lanes_any(lanes_greater(dist_sq, lanes_set(s.radius * s.radius))))
+        {
+            continue;
+        }
+        for (s64 k = 0; k < C_LANES; ++k)
+        {
+            s = sphere_add(s, point_at(points, i + k));
+        }
+    }
+    for (; i < points.count; ++i)
+    {
+        s = sphere_add(s, point_at(points, i));
+    }
+    return s;
+}
+
+template <typename Points>
+static Sphere sphere_from_points_lanes(Points const& points)
+{
+    if (points.count == 0)
+    {
+        return Sphere{};
+    }
+
+    // Ritter: the two far apart points found by two farthest point searches span the
+    // initial sphere, one growth pass then pulls in everything they missed.
+    Vec3 a = farthest_point(points, point_at(points, 0));
+    Vec3 b = farthest_point(points, a);
+    Sphere s = { (a + b) * 0.5f, magnitude(b - a) * 0.5f };
+    s = sphere_grow(points, s);
+
+    // Refinement: shrink the sphere and grow it back. The growth steps pull the center
+    // towards the points that stick out, which usually ends up tighter than before.
+    Sphere best = s;
+    for (s32 pass = 0; pass < C_SPHERE_REFINE_PASSES; ++pass)
+    {
+        s.radius *= C_SPHERE_REFINE_SHRINK;
+        s = sphere_grow(points, s);
+        if (s.radius < best.radius)
+        {
+            best = s;
+        }
+    }
+
+    // Rounding in the growth steps can leave a point a few ulps outside.
+    best.radius *= 1.0f + 1e-6f;
+    return best;
+}
+
+AABB aabb_from_points(Slice<Vec3> points)
+{
+    return aabb_from_points_lanes(points);
+}
+
+AABB aabb_from_points(Points_SoA const& points)
+{
+    return aabb_from_points_lanes(points);
+}
+
+Sphere sphere_from_points(Slice<Vec3> points)
+{
+    return sphere_from_points_lanes(points);
+}
+
+Sphere sphere_from_points(Points_SoA const& points)
+{
+    return sphere_from_points_lanes(points);
+}
+
+// The frustum planes broadcast to all lanes, abs_* are for the projected radius of boxes.
+struct Cull_Planes
+{
+    Lanes x[6], y[6], z[6], w[6];
+    Lanes abs_x[6], abs_y[6], abs_z[6];
+};
+
+static Cull_Planes cull_planes(Frustum const& frustum)
+{
+    Cull_Planes planes;
+    for (u32 i = 0; i < 6; ++i)
+    {
+        Vec4 p = frustum.planes[i];
+        planes.x[i] = lanes_set(p.x);
+        planes.y[i] = lanes_set(p.y);
+        planes.z[i] = lanes_set(p.z);
+        planes.w[i] = lanes_set(p.w);
+        planes.abs_x[i] = lanes_set(math_abs(p.x));
+        planes.abs_y[i] = lanes_set(math_abs(p.y));
+        planes.abs_z[i] = lanes_set(math_abs(p.z));
+    }
+    return planes;
+}
+
+// An object is visible if, for every plane, its distance plus its radius is positive.
+// Bit k is set if object first + k is visible.
+static u32 cull_spheres_lanes(Cull_Planes const& planes, Sphere_Batch const& spheres, s64 first)
+{
+    Lanes x = lanes_load(spheres.center_x + first);
+    Lanes y = lanes_load(spheres.center_y + first);
+    Lanes z = lanes_load(spheres.center_z + first);
+    Lanes r = lanes_load(spheres.radius + first);
+
+    Lanes min_dist = lanes_set(3.402823466e+38f);
+    for (u32 i = 0; i < 6; ++i)
+    {
+        Lanes dist = lanes_madd(planes.x[i], x, lanes_madd(planes.y[i], y, lanes_madd(planes.z[i], z, lanes_add(planes.w[i], r))));
+        min_dist = lanes_min(min_dist, dist);
+    }
+    return ~lanes_mask_bits(lanes_greater(lanes_set(0.0f), min_dist)) & ((1u << C_LANES) - 1);
+}
+
+static u32 cull_aabbs_lanes(Cull_Planes const& planes, AABB_Batch const& boxes, s64 first)
+{
+    Lanes half = lanes_set(0.5f);
+    Lanes min_x = lanes_load(boxes.min_x + first), max_x = lanes_load(boxes.max_x + first);
+    Lanes min_y = lanes_load(boxes.min_y + first), max_y = lanes_load(boxes.max_y + first);
+    Lanes min_z = lanes_load(boxes.min_z + first), max_z = lanes_load(boxes.max_z + first);
+    Lanes cx = lanes_mul(lanes_add(min_x, max_x), half), ex = lanes_mul(lanes_sub(max_x, min_x), half);
+    Lanes cy = lanes_mul(lanes_add(min_y, max_y), half), ey = lanes_mul(lanes_sub(max_y, min_y), half);
+    Lanes cz = lanes_mul(lanes_add(min_z, max_z), half), ez = lanes_mul(lanes_sub(max_z, min_z), half);
+
+    Lanes min_dist = lanes_set(3.402823466e+38f);
+    for (u32 i = 0; i < 6; ++i)
+    {
+        Lanes radius = lanes_madd(planes.abs_x[i], ex, lanes_madd(planes.abs_y[i], ey, lanes_mul(planes.abs_z[i], ez)));
+        Lanes dist = lanes_madd(planes.x[i], cx, lanes_madd(planes.y[i], cy, lanes_madd(planes.z[i], cz, lanes_add(planes.w[i], radius))));
+        min_dist = lanes_min(min_dist, dist);
+    }
+    return ~lanes_mask_bits(lanes_greater(lanes_set(0.0f), min_dist)) & ((1u << C_LANES) - 1);
+}
+
+// Appends first + k for every set bit k. Every index is written and the count only advances
+// past the visible ones, which avoids a branch per object. Nothing is written past the slot
+// of object first + k, as there can't be more visible objects than objects seen so far.
+static inline s64 write_visible(u32 visible_bits, s64 first, u32* out, s64 num_visible)
+{
+    for (s64 k = 0; k < C_LANES; ++k)
+    {
+        out[num_visible] = u32(first + k);
+        num_visible += (visible_bits >> k) & 1;
+    }
+    return num_visible;
+}
+
+// Enough batches to keep every worker busy, few enough to count them on the stack.
+constexpr s64 C_CULL_MAX_BATCHES = 256;
+
+struct Cull_Batch_Job
+{
+    Frustum const* frustum = nullptr;
+    Sphere_Batch const* spheres = nullptr;
+    AABB_Batch const* boxes = nullptr;
+    u32* out_visible = nullptr;
+    s64 batch_size = 0;
+    s64 batch_visible[C_CULL_MAX_BATCHES] = {};
+};
+
+// Each batch compacts its visible indices to the start of its own part of out_visible,
+// frustum_cull moves them together once all batches are done.
+static void cull_spheres_range(void* user, s64 begin, s64 end)
+{
+    Cull_Batch_Job* job = (Cull_Batch_Job*)user;
+    Cull_Planes planes = cull_planes(*job->frustum);
+    u32* out = job->out_visible + begin;
+    s64 num_visible = 0;
+
+    s64 i = begin;
+    for (; i + C_LANES <= end; i += C_LANES)
+    {
+        num_visible = write_visible(cull_spheres_lanes(planes, *job->spheres, i), i, out, num_visible);
+    }
+    for (; i < end; ++i)
+    {
+        Sphere sphere = { Vec3{ job->spheres->center_x[i], job->spheres->center_y[i], job->spheres->center_z[i] }, job->spheres->radius[i] };
+        out[num_visible] = u32(i);
+        num_visible += frustum_test_sphere(*job->frustum, sphere) ? 1 : 0;
+    }
+    job->batch_visible[begin / job->batch_size] = num_visible;
+}
+
+static void cull_aabbs_range(void* user, s64 begin, s64 end)
+{
+    Cull_Batch_Job* job = (Cull_Batch_Job*)user;
+    Cull_Planes planes = cull_planes(*job->frustum);
+    u32* out = job->out_visible + begin;
+    s64 num_visible = 0;
+
+    s64 i = begin;
+    for (; i + C_LANES <= end; i += C_LANES)
+    {
+        num_visible = write_visible(cull_aabbs_lanes(planes, *job->boxes, i), i, out, num_visible);
+    }
+    for (; i < end; ++i)
+    {
+        AABB box;
+        box.min = Vec3{ job->boxes->min_x[i], job->boxes->min_y[i], job->boxes->min_z[i] };
+        box.max = Vec3{ job->boxes->max_x[i], job->boxes->max_y[i], job->boxes->max_z[i] };
+        out[num_visible] = u32(i);
+        num_visible += frustum_test_aabb(*job->frustum, box) ? 1 : 0;
+    }
+    job->batch_visible[begin / job->batch_size] = num_visible;
+}
+
+static s64 frustum_cull(Cull_Batch_Job* job, s64 count, Job_Range_Fn fn, Job_System* jobs)
+{
+    // Batches are multiples of C_LANES, so only the very last one has a scalar tail.
+    s64 batch_size = (count + C_CULL_MAX_BATCHES - 1) / C_CULL_MAX_BATCHES;
+    batch_size = (batch_size + C_LANES - 1) / C_LANES * C_LANES;
+    job->batch_size = batch_size > C_CULL_BATCH_JOB_SIZE ? batch_size : C_CULL_BATCH_JOB_SIZE;
+
+    job_parallel_for(jobs, count, job->batch_size, fn, job);
+
+    s64 num_visible = 0;
+    for (s64 begin = 0, batch = 0; begin < count; begin += job->batch_size, ++batch)
+    {
+        s64 batch_visible = job->batch_visible[batch];
+        if (begin != num_visible)
+        {
+            memmove(job->out_visible + num_visible, job->out_visible + begin, batch_visible * sizeof(u32));
+        }
+        num_visible += batch_visible;
+    }
+    return num_visible;
+}
+
+s64 frustum_cull_spheres(Frustum const& frustum, Sphere_Batch const& spheres, u32* out_visible, Job_System* jobs)
+{
+    Cull_Batch_Job job;
+    job.frustum = &frustum;
+    job.spheres = &spheres;
+    job.out_visible = out_visible;
+    return frustum_cull(&job, spheres.count, cull_spheres_range, jobs);
+}
+
+s64 frustum_cull_aabbs(Frustum const& frustum, AABB_Batch const& boxes, u32* out_visible, Job_System* jobs)
+{
+    Cull_Batch_Job job;
+    job.frustum = &frustum;
+    job.boxes = &boxes;
+    job.out_visible = out_visible;
+    return frustum_cull(&job, boxes.count, cull_aabbs_range, jobs);
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "core.h"
+#include "mathlib.h"
+#include "memory.h"
+
+struct Job_System;
+
+// Bulk versions of mat4_mul(view_projection, model), sincos and frustum culling for scenes
+// with many objects, and bounding volumes over vertex positions.
+// The TRS variant reads its inputs as structure of arrays, so one SIMD register holds the
+// same component of 8 (AVX2) or 4 (SSE, NEON) objects and the whole model and MVP matrix
+// computation runs across objects instead of within one matrix. The models variant
+// transposes its input matrices into the same layout as it goes. The results are written
+// as regular Mat4s, ready to be copied to the GPU.
+//
+// Passing a Job_System splits the work across its workers, anything below
+// C_MVP_BATCH_JOB_SIZE objects per worker isn't worth waking them up for.
+
+constexpr s64 C_MVP_BATCH_JOB_SIZE = 4096;
+constexpr s64 C_SINCOS_BATCH_JOB_SIZE = 16384;
+constexpr s64 C_CULL_BATCH_JOB_SIZE = 16384;
+
+// The components of a Transform per object. Rotations are unit quaternions, every array holds `count` elements.
+struct TRS_Batch
+{
+    f32 const* pos_x = nullptr;
+    f32 const* pos_y = nullptr;
+    f32 const* pos_z = nullptr;
+    f32 const* rot_x = nullptr;
+    f32 const* rot_y = nullptr;
+    f32 const* rot_z = nullptr;
+    f32 const* rot_w = nullptr;
+    f32 const* scale_x = nullptr;
+    f32 const* scale_y = nullptr;
+    f32 const* scale_z = nullptr;
+    s64 count = 0;
+};
+
+// out_mvps[i] = view_projection * translate(pos[i]) * rotate(rot[i]) * scale(scale[i])
+void mvp_batch_from_trs(Mat4 const& view_projection, TRS_Batch const& trs, Mat4* out_mvps, Job_System* jobs = nullptr);
+
+// out_mvps[i] = view_projection * models[i]
+void mvp_batch_from_models(Mat4 const& view_projection, Slice<Mat4> models, Mat4* out_mvps, Job_System* jobs = nullptr);
+
+// out_sin[i], out_cos[i] = sincos(x[i], accuracy), with the same error bounds. HIGH and LOW run
+// 8 (AVX2) or 4 (SSE, NEON) values at a time, LIBM has no vector version and loops over sinf/cosf.
+void sincos_batch(f32 const* x, f32* out_sin, f32* out_cos, s64 count, Trig_Accuracy accuracy, Job_System* jobs = nullptr);
+
+// Positions as structure of arrays, every array holds `count` elements.
+struct Points_SoA
+{
+    f32 const* x = nullptr;
+    f32 const* y = nullptr;
+    f32 const* z = nullptr;
+    s64 count = 0;
+};
+
+constexpr s32 C_SPHERE_REFINE_PASSES = 8;
+constexpr f32 C_SPHERE_REFINE_SHRINK = 0.95f;
+
+// Tight bounds, 8 (AVX2) or 4 (SSE, NEON) points at a time. Meant to run once per mesh when
+// it is loaded, so they stay on the calling thread. No points gives an empty AABB or Sphere.
+AABB aabb_from_points(Slice<Vec3> points);
+AABB aabb_from_points(Points_SoA const& points);
+
+// Ritter's sphere followed by C_SPHERE_REFINE_PASSES passes that shrink it and grow it
+// back over all points, keeping the smallest. The refinement matters most for meshes with
+// few vertices, on dense ones Ritter alone tends to be close to the minimal sphere already.
+Sphere sphere_from_points(Slice<Vec3> points);
+Sphere sphere_from_points(Points_SoA const& points);
+
+// Bounding volumes per object, every array holds `count` elements.
+struct Sphere_Batch
+{
+    f32 const* center_x = nullptr;
+    f32 const* center_y = nullptr;
+    f32 const* center_z = nullptr;
+    f32 const* radius = nullptr;
+    s64 count = 0;
+};
+
+struct AABB_Batch
+{
+    f32 const* min_x = nullptr;
+    f32 const* min_y = nullptr;
+    f32 const* min_z = nullptr;
+    f32 const* max_x = nullptr;
+    f32 const* max_y = nullptr;
+    f32 const* max_z = nullptr;
+    s64 count = 0;
+};
+
+// frustum_test_sphere and frustum_test_aabb for 8 (AVX2) or 4 (SSE, NEON) objects at a time.
+// Writes the indices of the objects that may be visible to out_visible in increasing order
+// and returns how many there are. out_visible needs room for `count` indices, all of it may
+// be written to.
+s64 frustum_cull_spheres(Frustum const& frustum, Sphere_Batch const& spheres, u32* out_visible, Job_System* jobs = nullptr);
+s64 frustum_cull_aabbs(Frustum const& frustum, AABB_Batch const& boxes, u32* out_visible, Job_System* jobs = nullptr);
@@ -2,16 +2,218 @@
 #include "core.h"
 #include <math.h>
 
+// The Vec4 and Mat4 kernels below have SIMD versions that are picked at compile time.
+// The scalar versions in detail:: are kept as the reference and used everywhere else.
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MATH_SSE 1
+#define MATH_NEON 0
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MATH_SSE 0
+#define MATH_NEON 1
+#else
+#define MATH_SSE 0
+#define MATH_NEON 0
+#endif
+
+#if MATH_SSE && defined(__AVX__)
+#include <immintrin.h>
+#define MATH_AVX 1
+#else
+#define MATH_AVX 0
+#endif
+
+// Everything in here is constexpr so constant transforms and the self-tests at the bottom fold
+// at compile time. Intrinsics can't be constant evaluated, so the SIMD kernels switch to their
+// scalar reference when they are.
+#define MATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+
 constexpr f32 Pi = 3.1415926535f;
 
 constexpr bool left_handed = true;
 
-static f32 degree_to_rad(f32 degrees)
+namespace detail
+{
+    constexpr f64 C_PI_F64 = 3.14159265358979323846;
+
+    // Wraps x into [-pi, pi].
+    static constexpr f64 wrap_angle(f64 x)
+    {
+        f64 turns = x / (2.0 * C_PI_F64);
+        s64 whole = s64(turns >= 0.0 ? turns + 0.5 : turns - 0.5);
+        return x - f64(whole) * 2.0 * C_PI_F64;
+    }
+
+    // Taylor series, well converged after 12 terms on [-pi, pi].
+    static constexpr f64 sin_series(f64 x)
+    {
+        x = wrap_angle(x);
+        f64 term = x;
+        f64 sum = x;
+        for (int i = 1; i <= 12; ++i)
+        {
+            term *= -x * x / f64((2 * i) * (2 * i + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static constexpr f64 cos_series(f64 x)
+    {
+        x = wrap_angle(x);
+        f64 term = 1.0;
+        f64 sum = 1.0;
+        for (int i = 1; i <= 12; ++i)
+        {
+            term *= -x * x / f64((2 * i - 1) * (2 * i));
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Newton iteration from above, stops once it doesn't move anymore.
+    static constexpr f64 sqrt_newton(f64 x)
+    {
+        f64 guess = x > 1.0 ? x : 1.0;
+        for (int i = 0; i < 128; ++i)
+        {
+            f64 next = 0.5 * (guess + x / guess);
+            if (next >= guess) break;
+            guess = next;
+        }
+        return guess;
+    }
+}
+
+// <math.h> isn't constexpr. These call it at runtime and use the series above during constant
+// evaluation, so compile time results can be off from the runtime ones in the last bit.
+static constexpr f32 math_sqrt(f32 x)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        ASSERT(x >= 0.0f);
+        return f32(detail::sqrt_newton(f64(x)));
+    }
+    return sqrtf(x);
+}
+
+static constexpr f32 math_sin(f32 x)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return f32(detail::sin_series(f64(x)));
+    }
+    return sinf(x);
+}
+
+static constexpr f32 math_cos(f32 x)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return f32(detail::cos_series(f64(x)));
+    }
+    return cosf(x);
+}
+
+static constexpr f32 math_abs(f32 x)
+{
+    return x < 0.0f ? -x : x;
+}
+
+static constexpr f32 math_max(f32 a, f32 b)
+{
+    return a > b ? a : b;
+}
+
+struct Sin_Cos
+{
+    f32 sin = 0.0f;
+    f32 cos = 1.0f;
+};
+
+// Picked per call site. The errors are the max absolute error against the f64 result
+// for |x| <= 1e4, range reduction loses precision beyond that.
+enum class Trig_Accuracy : u8
+{
+    LIBM, // sinf and cosf, which most compilers merge into a single sincosf call.
+    HIGH, // 1e-7, within a few ulp of libm.
+    LOW,  // 4e-5, for animation, camera orbits and anything else that only has to look right.
+};
+
+namespace detail
+{
+    constexpr f32 C_TWO_OVER_PI = 0.636619772f;
+
+    // pi/2 split into three floats (Cody-Waite). The first two have few enough mantissa bits
+    // that j times them is exact, so the remainder keeps its low bits.
+    constexpr f32 C_HALF_PI_1 = 1.5703125f;
+    constexpr f32 C_HALF_PI_2 = 4.837512969970703125e-4f;
+    constexpr f32 C_HALF_PI_3 = 7.549789948768648e-8f;
+
+    // Minimax polynomials on [-pi/4, pi/4]. The HIGH ones are the Cephes sinf/cosf kernels.
+    constexpr f32 C_SIN_HIGH_1 = -1.6666654611e-1f;
+    constexpr f32 C_SIN_HIGH_2 = 8.3321608736e-3f;
+    constexpr f32 C_SIN_HIGH_3 = -1.9515295891e-4f;
+    constexpr f32 C_COS_HIGH_1 = 4.166664568298827e-2f;
+    constexpr f32 C_COS_HIGH_2 = -1.388731625493765e-3f;
+    constexpr f32 C_COS_HIGH_3 = 2.443315711809948e-5f;
+    constexpr f32 C_SIN_LOW_1 = -1.6666667e-1f;
+    constexpr f32 C_SIN_LOW_2 = 8.2227164e-3f;
+    constexpr f32 C_COS_LOW_1 = -0.5f;
+    constexpr f32 C_COS_LOW_2 = 4.0908444e-2f;
+
+    // x = j * pi/2 + r with r in [-pi/4, pi/4], then sin and cos of r pick and flip
+    // depending on the quadrant j.
+    static constexpr Sin_Cos sincos_poly(f32 x, bool high)
+    {
+        f32 q = x * C_TWO_OVER_PI;
+        s32 j = s32(q + (f32(q >= 0.0f) - 0.5f));
+        f32 r = ((x - f32(j) * C_HALF_PI_1) - f32(j) * C_HALF_PI_2) - f32(j) * C_HALF_PI_3;
+        f32 r2 = r * r;
+
+        f32 sin_r;
+        f32 cos_r;
+        if (high)
+        {
+            sin_r = r + r * r2 * (C_SIN_HIGH_1 + r2 * (C_SIN_HIGH_2 + r2 * C_SIN_HIGH_3));
+            cos_r = 1.0f - 0.5f * r2 + r2 * r2 * (C_COS_HIGH_1 + r2 * (C_COS_HIGH_2 + r2 * C_COS_HIGH_3));
+        }
+        else
+        {
+            sin_r = r + r * r2 * (C_SIN_LOW_1 + r2 * C_SIN_LOW_2);
+            cos_r = 1.0f + r2 * (C_COS_LOW_1 + r2 * C_COS_LOW_2);
+        }
+
+        // Branch free here and in the rounding above, the quadrant and sign of random angles
+        // are unpredictable. Multiplying by 0 or +-1 and adding 0 is exact, so this matches
+        // picking and negating, apart from the sign of a zero result.
+        f32 odd = f32(j & 1);
+        f32 even = 1.0f - odd;
+        Sin_Cos result;
+        result.sin = (sin_r * even + cos_r * odd) * f32(1 - (j & 2));
+        result.cos = (cos_r * even + sin_r * odd) * f32(1 - ((j + 1) & 2));
+        return result;
+    }
+}
+
+static constexpr Sin_Cos sincos(f32 x, Trig_Accuracy accuracy = Trig_Accuracy::LIBM)
+{
+    switch (accuracy)
+    {
+    case Trig_Accuracy::HIGH: return detail::sincos_poly(x, true);
+    case Trig_Accuracy::LOW: return detail::sincos_poly(x, false);
+    case Trig_Accuracy::LIBM: break;
+    }
+    return Sin_Cos{ math_sin(x), math_cos(x) };
+}
+
+static constexpr f32 degree_to_rad(f32 degrees)
 {
     return degrees * (Pi / 180.0f);
 }
 
-static f32 rad_to_degree(f32 radians)
+static constexpr f32 rad_to_degree(f32 radians)
 {
     return radians * (180.0f / Pi);
 }
@@ -28,14 +230,14 @@ struct Degrees
 };
 
 template <typename T>
-static T clamp(T v, T min, T max) {
+static constexpr T clamp(T v, T min, T max) {
     if (v < min) return min;
     else if (v > max) return max;
     else return v;
 }
 
 template <typename T>
-static T lerp(T a, T b, f32 t) {
+static constexpr T lerp(T a, T b, f32 t) {
     return a * t + b * (1.0 - t);
 }
 
@@ -44,51 +246,51 @@ struct Vec2
     f32 x = 0.0f;
     f32 y = 0.0f;
 
-    Vec2& operator+=(Vec2 other);
+    constexpr Vec2& operator+=(Vec2 other);
 };
 
-static Vec2 vec2_add(Vec2 lhs, Vec2 rhs)
+static constexpr Vec2 vec2_add(Vec2 lhs, Vec2 rhs)
 {
     return Vec2{ lhs.x + rhs.x, lhs.y + rhs.y };
 }
 
-static Vec2 vec2_sub(Vec2 lhs, Vec2 rhs)
+static constexpr Vec2 vec2_sub(Vec2 lhs, Vec2 rhs)
 {
     return Vec2{ lhs.x - rhs.x, lhs.y - rhs.y };
 }
 
-static Vec2 vec2_mul(Vec2 lhs, Vec2 rhs)
+static constexpr Vec2 vec2_mul(Vec2 lhs, Vec2 rhs)
 {
     return Vec2{ lhs.x * rhs.x, lhs.y * rhs.y };
 }
 
-static Vec2 vec2_div(Vec2 lhs, Vec2 rhs)
+static constexpr Vec2 vec2_div(Vec2 lhs, Vec2 rhs)
 {
     return Vec2{ lhs.x / rhs.x, lhs.y / rhs.y };
 }
 
-static Vec2 vec2_mul(Vec2 v, f32 f)
+static constexpr Vec2 vec2_mul(Vec2 v, f32 f)
 {
     return Vec2{ v.x * f, v.y * f };
 }
 
-Vec2& Vec2::operator+=(Vec2 other)
+constexpr Vec2& Vec2::operator+=(Vec2 other)
 {
     *this = vec2_add(*this, other);
     return *this;
 }
 
-static Vec2 operator*(Vec2 lhs, Vec2 rhs)
+static constexpr Vec2 operator*(Vec2 lhs, Vec2 rhs)
 {
     return vec2_mul(lhs, rhs);
 }
 
-static Vec2 operator+(Vec2 lhs, Vec2 rhs)
+static constexpr Vec2 operator+(Vec2 lhs, Vec2 rhs)
 {
     return vec2_add(lhs, rhs);
 }
 
-static Vec2 operator*(Vec2 v, f32 f)
+static constexpr Vec2 operator*(Vec2 v, f32 f)
 {
     return vec2_mul(v, f);
 }
@@ -99,36 +301,41 @@ struct Vec3
     f32 y = 0.0f;
     f32 z = 0.0f;
 
-    Vec3& operator+=(Vec3 other);
-    Vec3& operator*=(Vec3 other);
-    Vec3& operator-=(Vec3 other);
+    constexpr Vec3& operator+=(Vec3 other);
+    constexpr Vec3& operator*=(Vec3 other);
+    constexpr Vec3& operator-=(Vec3 other);
 
-    Vec3& operator+=(f32 val);
-    Vec3& operator*=(f32 val);
+    constexpr Vec3& operator+=(f32 val);
+    constexpr Vec3& operator*=(f32 val);
 
     f32& operator[](int i)
     {
-        ASSERT(i >= 0 && i <= 2);
+        ASSERT_DEBUG(i >= 0 && i <= 2);
+        return ((f32*)this)[i];
+    }
+
+    f32& get_unchecked(int i)
+    {
         return ((f32*)this)[i];
     }
 };
 
-static Vec3 vec3_zero()
+static constexpr Vec3 vec3_zero()
 {
     return Vec3{ 0.f, 0.f, 0.f };    
 }
 
-static Vec3 negate(Vec3 v)
+static constexpr Vec3 negate(Vec3 v)
 {
     return Vec3{-v.x, -v.y, -v.z};
 }
 
-static Vec3 operator-(Vec3 v)
+static constexpr Vec3 operator-(Vec3 v)
 {
     return negate(v);
 }
 
-static Vec3 clamp(Vec3 v, f32 min, f32 max) {
+static constexpr Vec3 clamp(Vec3 v, f32 min, f32 max) {
     return Vec3 {
         clamp(v.x, min, max),
         clamp(v.y, min, max),
@@ -136,7 +343,7 @@ static Vec3 clamp(Vec3 v, f32 min, f32 max) {
     };
 }
 
-static Vec3 vec3_mul(Vec3 lhs, Vec3 rhs)
+static constexpr Vec3 vec3_mul(Vec3 lhs, Vec3 rhs)
 {
     return Vec3
     {
@@ -146,7 +353,7 @@ static Vec3 vec3_mul(Vec3 lhs, Vec3 rhs)
     };
 }
 
-static Vec3 vec3_add(Vec3 lhs, Vec3 rhs)
+static constexpr Vec3 vec3_add(Vec3 lhs, Vec3 rhs)
 {
     return Vec3
     {
@@ -156,7 +363,7 @@ static Vec3 vec3_add(Vec3 lhs, Vec3 rhs)
     };
 }
 
-static Vec3 vec3_sub(Vec3 lhs, Vec3 rhs)
+static constexpr Vec3 vec3_sub(Vec3 lhs, Vec3 rhs)
 {
     return Vec3
     {
@@ -166,7 +373,7 @@ static Vec3 vec3_sub(Vec3 lhs, Vec3 rhs)
     };
 }
 
-static Vec3 vec3_mul(Vec3 lhs, f32 rhs)
+static constexpr Vec3 vec3_mul(Vec3 lhs, f32 rhs)
 {
     return Vec3
     {
@@ -176,7 +383,7 @@ static Vec3 vec3_mul(Vec3 lhs, f32 rhs)
     };
 }
 
-static Vec3 vec3_add(Vec3 lhs, f32 rhs)
+static constexpr Vec3 vec3_add(Vec3 lhs, f32 rhs)
 {
     return Vec3
     {
@@ -186,7 +393,7 @@ static Vec3 vec3_add(Vec3 lhs, f32 rhs)
     };
 }
 
-static Vec3 vec3_div(Vec3 lhs, f32 rhs)
+static constexpr Vec3 vec3_div(Vec3 lhs, f32 rhs)
 {
     return Vec3
     {
@@ -196,77 +403,77 @@ static Vec3 vec3_div(Vec3 lhs, f32 rhs)
     };
 }
 
-Vec3& Vec3::operator+=(Vec3 other)
+constexpr Vec3& Vec3::operator+=(Vec3 other)
 {
     *this = vec3_add(*this, other);
     return *this;
 }
 
-Vec3& Vec3::operator*=(Vec3 other)
+constexpr Vec3& Vec3::operator*=(Vec3 other)
 {
     *this = vec3_mul(*this, other);
     return *this;
 }
 
-Vec3& Vec3::operator-=(Vec3 other)
+constexpr Vec3& Vec3::operator-=(Vec3 other)
 {
     *this = vec3_sub(*this, other);
     return *this;
 }
 
-Vec3& Vec3::operator+=(f32 val)
+constexpr Vec3& Vec3::operator+=(f32 val)
 {
     *this = vec3_add(*this, val);
     return *this;
 }
 
-Vec3& Vec3::operator*=(f32 val)
+constexpr Vec3& Vec3::operator*=(f32 val)
 {
     *this = vec3_mul(*this, val);
     return *this;
 }
 
-static Vec3 operator+(Vec3 lhs, Vec3 rhs)
+static constexpr Vec3 operator+(Vec3 lhs, Vec3 rhs)
 {
     return vec3_add(lhs, rhs);
 }
 
-static Vec3 operator*(Vec3 lhs, Vec3 rhs)
+static constexpr Vec3 operator*(Vec3 lhs, Vec3 rhs)
 {
     return vec3_mul(lhs, rhs);
 }
 
-static Vec3 operator-(Vec3 lhs, Vec3 rhs)
+static constexpr Vec3 operator-(Vec3 lhs, Vec3 rhs)
 {
     return vec3_sub(lhs, rhs);
 }
 
-static Vec3 operator+(Vec3 v, f32 s)
+static constexpr Vec3 operator+(Vec3 v, f32 s)
 {
     return vec3_add(v, s);
 }
 
-static Vec3 operator*(Vec3 v, f32 s)
+static constexpr Vec3 operator*(Vec3 v, f32 s)
 {
     return vec3_mul(v, s);
 }
 
-static f32 magnitude(Vec3 v)
+static constexpr f32 magnitude(Vec3 v)
 {
-    return sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    return math_sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
 }
 
-static Vec3 normalized(Vec3 v)
+static constexpr Vec3 normalized(Vec3 v)
 {
     return vec3_div(v, magnitude(v));
 }
 
-static f32 dot(Vec3 a, Vec3 b)
+static constexpr f32 dot(Vec3 a, Vec3 b)
 {
     return a.x * b.x + a.y * b.y + a.z * b.z;
 }
 
-static Vec3 cross(Vec3 a, Vec3 b)
+static constexpr Vec3 cross(Vec3 a, Vec3 b)
 {
     return Vec3 {
         a.y * b.z - a.z * b.y,
@@ -284,68 +491,159 @@ struct Vec4
 
     f32& operator[](int i)
     {
-        ASSERT(i >= 0 && i <= 3);
+        ASSERT_DEBUG(i >= 0 && i <= 3);
+        return ((f32*)this)[i];
+    }
+
+    f32& get_unchecked(int i)
+    {
         return ((f32*)this)[i];
     }
 };
 
+namespace detail
+{
+    static constexpr f32 dot_scalar(Vec4 a, Vec4 b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    }
+
+    // Crosses the xyz parts, w is zero.
+    static constexpr Vec4 cross_scalar(Vec4 a, Vec4 b)
+    {
+        return Vec4 {
+            a.y * b.z - a.z * b.y,
+            a.z * b.x - a.x * b.z,
+            a.x * b.y - a.y * b.x,
+            0.0f
+        };
+    }
+
+    static constexpr Vec4 normalized_scalar(Vec4 v)
+    {
+        f32 len = math_sqrt(dot_scalar(v, v));
+        return Vec4{ v.x / len, v.y / len, v.z / len, v.w / len };
+    }
+
+#if MATH_SSE
+    static inline __m128 vec4_load(Vec4 const& v) { return _mm_loadu_ps(&v.x); }
+
+    static inline Vec4 vec4_store(__m128 r)
+    {
+        Vec4 out;
+        _mm_storeu_ps(&out.x, r);
+        return out;
+    }
+
+    // Sum of all four lanes, broadcast to every lane.
+    static inline __m128 hsum_ps(__m128 v)
+    {
+        __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(v, shuf);
+        shuf = _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2));
+        return _mm_add_ps(sums, shuf);
+    }
+#elif MATH_NEON
+    static inline float32x4_t vec4_load(Vec4 const& v) { return vld1q_f32(&v.x); }
+
+    static inline Vec4 vec4_store(float32x4_t r)
+    {
+        Vec4 out;
+        vst1q_f32(&out.x, r);
+        return out;
+    }
+#endif
+}
+
+static constexpr f32 dot(Vec4 a, Vec4 b)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::dot_scalar(a, b);
+    }
+
+#if MATH_SSE
+    return _mm_cvtss_f32(detail::hsum_ps(_mm_mul_ps(detail::vec4_load(a), detail::vec4_load(b))));
+#elif MATH_NEON
+    return vaddvq_f32(vmulq_f32(detail::vec4_load(a), detail::vec4_load(b)));
+#else
+    return detail::dot_scalar(a, b);
+#endif
+}
+
+static constexpr Vec4 cross(Vec4 a, Vec4 b)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::cross_scalar(a, b);
+    }
+
+#if MATH_SSE
+    // a.yzx * b.zxy - a.zxy * b.yzx, which leaves 0 in w.
+    __m128 va = detail::vec4_load(a);
+    __m128 vb = detail::vec4_load(b);
+    __m128 a_yzx = _mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 b_yzx = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 c = _mm_sub_ps(_mm_mul_ps(va, b_yzx), _mm_mul_ps(a_yzx, vb));
+    return detail::vec4_store(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+#else
+    // Shuffles are awkward on NEON and the scalar version compiles to about the same.
+    return detail::cross_scalar(a, b);
+#endif
+}
+
+static constexpr Vec4 normalized(Vec4 v)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::normalized_scalar(v);
+    }
+
+#if MATH_SSE
+    __m128 vv = detail::vec4_load(v);
+    __m128 len = _mm_sqrt_ps(detail::hsum_ps(_mm_mul_ps(vv, vv)));
+    return detail::vec4_store(_mm_div_ps(vv, len));
+#elif MATH_NEON
+    float32x4_t vv = detail::vec4_load(v);
+    float32x4_t len = vdupq_n_f32(sqrtf(vaddvq_f32(vmulq_f32(vv, vv))));
+    return detail::vec4_store(vdivq_f32(vv, len));
+#else
+    return detail::normalized_scalar(v);
+#endif
+}
+
 // We use column major convention.
 // https://fgiesen.wordpress.com/2012/02/12/row-major-vs-column-major-row-vectors-vs-column-vectors/
 
-struct Mat4
+struct alignas(16) Mat4
 {
-    union
-    {
-        f32 m[16];
-        struct
-        {
-            f32 m00; f32 m10; f32 m20; f32 m30;
-            f32 m01; f32 m11; f32 m21; f32 m31;
-            f32 m02; f32 m12; f32 m22; f32 m32;
-            f32 m03; f32 m13; f32 m23; f32 m33;
-        };
-    };
+    f32 m[16];
 
     Mat4() = default;
 
-    Mat4(f32 m00, f32 m01, f32 m02, f32 m03,
+    constexpr Mat4(f32 m00, f32 m01, f32 m02, f32 m03,
             f32 m10, f32 m11, f32 m12, f32 m13,
             f32 m20, f32 m21, f32 m22, f32 m23,
             f32 m30, f32 m31, f32 m32, f32 m33)
+        : m{ m00, m10, m20, m30,
+             m01, m11, m21, m31,
+             m02, m12, m22, m32,
+             m03, m13, m23, m33 }
     {
-        this->m00 = m00;
-        this->m10 = m10;
-        this->m20 = m20;
-        this->m30 = m30;
-
-        this->m01 = m01;
-        this->m11 = m11;
-        this->m21 = m21;
-        this->m31 = m31;
-
-        this->m02 = m02;
-        this->m12 = m12;
-        this->m22 = m22;
-        this->m32 = m32;
-
-        this->m03 = m03;
-        this->m13 = m13;
-        this->m23 = m23;
-        this->m33 = m33;
     }
 
-    f32& operator()(u32 row, u32 col)
+    constexpr f32& operator()(u32 row, u32 col)
     {
         return m[4 * col + row];
     }
 
-    f32 const& operator()(u32 row, u32 col) const
+    constexpr f32 const& operator()(u32 row, u32 col) const
     {
         return m[4 * col + row];
     }
 };
 
-static Mat4 mat4_zero()
+static constexpr Mat4 mat4_zero()
 {
     return Mat4(
         0.f, 0.f, 0.f, 0.f,
@@ -355,7 +653,7 @@ static Mat4 mat4_zero()
     );
 }
 
-static Mat4 mat4_identity()
+static constexpr Mat4 mat4_identity()
 {
     return Mat4(
         1.f, 0.f, 0.f, 0.f,
@@ -365,7 +663,7 @@ static Mat4 mat4_identity()
     );
 }
 
-static bool mat4_eq(Mat4 const& lhs, Mat4 const& rhs)
+static constexpr bool mat4_eq(Mat4 const& lhs, Mat4 const& rhs)
 {
     for (u32 row = 0; row < 4; ++row)
     {
@@ -377,96 +675,176 @@ static bool mat4_eq(Mat4 const& lhs, Mat4 const& rhs)
     return true;
 }
 
-static Mat4 mat4_mul(Mat4 const& lhs, Mat4 const& rhs)
+static constexpr bool mat4_approx_eq(Mat4 const& lhs, Mat4 const& rhs, f32 rel_epsilon = 1e-6f)
 {
-    Mat4 result = mat4_zero();
+    for (u32 i = 0; i < 16; ++i)
+    {
+        f32 diff = math_abs(lhs.m[i] - rhs.m[i]);
+        f32 scale = math_max(1.0f, math_max(math_abs(lhs.m[i]), math_abs(rhs.m[i])));
+        if (diff > rel_epsilon * scale) return false;
+    }
+    return true;
+}
 
-    for (u32 row = 0; row < 4; ++row)
+namespace detail
+{
+    static constexpr Mat4 mat4_mul_scalar(Mat4 const& lhs, Mat4 const& rhs)
     {
-        for (u32 col = 0; col < 4; ++col)
+        Mat4 result = mat4_zero();
+
+        for (u32 row = 0; row < 4; ++row)
         {
-            f32& field = result(row, col);
-            field += lhs(row, 0) * rhs(0, col);
-            field += lhs(row, 1) * rhs(1, col);
-            field += lhs(row, 2) * rhs(2, col);
-            field += lhs(row, 3) * rhs(3, col);
+            for (u32 col = 0; col < 4; ++col)
+            {
+                f32& field = result(row, col);
+                field += lhs(row, 0) * rhs(0, col);
+                field += lhs(row, 1) * rhs(1, col);
+                field += lhs(row, 2) * rhs(2, col);
+                field += lhs(row, 3) * rhs(3, col);
+            }
         }
+
+        return result;
     }
 
-    return result;
-}
+    static constexpr Vec4 mat4_mul_scalar(Mat4 const& m, Vec4 v)
+    {
+        return Vec4 {
+            m(0, 0) * v.x + m(0, 1) * v.y + m(0, 2) * v.z + m(0, 3) * v.w,
+            m(1, 0) * v.x + m(1, 1) * v.y + m(1, 2) * v.z + m(1, 3) * v.w,
+            m(2, 0) * v.x + m(2, 1) * v.y + m(2, 2) * v.z + m(2, 3) * v.w,
+            m(3, 0) * v.x + m(3, 1) * v.y + m(3, 2) * v.z + m(3, 3) * v.w
+        };
+    }
 
-static Vec4 mat4_mul(Mat4 const& m, Vec4 v)
-{
-    Vec4 out;
-    for (int i = 0; i < 4; ++i)
+    static constexpr Mat4 transpose_scalar(Mat4 const& m)
     {
-        out[i] = m(i, 0) * v[0] + m(i, 1) * v[1] + m(i, 2) * v[2] + m(i, 3) * v[3]; 
+        Mat4 out = m;
+
+        for (int i = 0; i < 4; i++)
+        {
+            for (int j = i + 1; j < 4; j++)
+            {
+                f32 temp = out(i, j);
+                out(i, j) = out(j, i);
+                out(j, i) = temp;
+            }
+        }
+        return out;
     }
-    return out;
 }
 
-static void test_mat4_mul()
+// Column j of the result is lhs * (column j of rhs), i.e. the columns of lhs weighted by rhs(k, j).
+static constexpr Mat4 mat4_mul(Mat4 const& lhs, Mat4 const& rhs)
 {
-    Mat4 lhs(
-        1.f, 8.f, 4.f, 5.f,
-        6.f, 2.f, 1.f, 7.f,
-        3.f, 9.f, 9.f, 2.f,
-        8.f, 6.f, 4.f, 5.f
-    );
-
-    Mat4 rhs(
-        8.f, 2.f, 9.f, 2.f,
-        3.f, 5.f, 4.f, 1.f,
-        7.f, 6.f, 3.f, 2.f,
-        9.f, 8.f, 5.f, 7.f
-    );
-
-    Mat4 l_to_r = mat4_mul(lhs, rhs);
-    Mat4 l_to_r_expected(
-        105.f, 106.f, 78.f, 53.f,
-        124.f, 84.f, 100.f, 65.f,
-        132.f, 121.f, 100.f, 47.f,
-        155.f, 110.f, 133.f, 65.f
-    );
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::mat4_mul_scalar(lhs, rhs);
+    }
 
-    ASSERT(mat4_eq(l_to_r_expected, l_to_r));
+    Mat4 result;
+#if MATH_AVX
+    // Two result columns per iteration: each lane half holds one column of lhs, and the
+    // in-lane shuffles broadcast rhs(k, j) into the low half and rhs(k, j + 1) into the high half.
+    // Mat4 is only 16 byte aligned, so the 32 byte loads and stores have to be unaligned ones.
+    __m256 c0 = _mm256_broadcast_ps((__m128 const*)&lhs.m[0]);
+    __m256 c1 = _mm256_broadcast_ps((__m128 const*)&lhs.m[4]);
+    __m256 c2 = _mm256_broadcast_ps((__m128 const*)&lhs.m[8]);
+    __m256 c3 = _mm256_broadcast_ps((__m128 const*)&lhs.m[12]);
+    for (int j = 0; j < 4; j += 2)
+    {
+        __m256 r = _mm256_loadu_ps(&rhs.m[4 * j]);
+        __m256 acc = _mm256_mul_ps(c0, _mm256_shuffle_ps(r, r, 0x00));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(c1, _mm256_shuffle_ps(r, r, 0x55)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(c2, _mm256_shuffle_ps(r, r, 0xAA)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(c3, _mm256_shuffle_ps(r, r, 0xFF)));
+        _mm256_storeu_ps(&result.m[4 * j], acc);
+    }
+#elif MATH_SSE
+    __m128 c0 = _mm_load_ps(&lhs.m[0]);
+    __m128 c1 = _mm_load_ps(&lhs.m[4]);
+    __m128 c2 = _mm_load_ps(&lhs.m[8]);
+    __m128 c3 = _mm_load_ps(&lhs.m[12]);
+    for (int j = 0; j < 4; ++j)
+    {
+        __m128 acc = _mm_mul_ps(c0, _mm_set1_ps(rhs.m[4 * j + 0]));
+        acc = _mm_add_ps(acc, _mm_mul_ps(c1, _mm_set1_ps(rhs.m[4 * j + 1])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(c2, _mm_set1_ps(rhs.m[4 * j + 2])));
+        acc = _mm_add_ps(acc, _mm_mul_ps(c3, _mm_set1_ps(rhs.m[4 * j + 3])));
+        _mm_store_ps(&result.m[4 * j], acc);
+    }
+#elif MATH_NEON
+    float32x4_t c0 = vld1q_f32(&lhs.m[0]);
+    float32x4_t c1 = vld1q_f32(&lhs.m[4]);
+    float32x4_t c2 = vld1q_f32(&lhs.m[8]);
+    float32x4_t c3 = vld1q_f32(&lhs.m[12]);
+    for (int j = 0; j < 4; ++j)
+    {
+        float32x4_t r = vld1q_f32(&rhs.m[4 * j]);
+        float32x4_t acc = vmulq_laneq_f32(c0, r, 0);
+        acc = vfmaq_laneq_f32(acc, c1, r, 1);
+        acc = vfmaq_laneq_f32(acc, c2, r, 2);
+        acc = vfmaq_laneq_f32(acc, c3, r, 3);
+        vst1q_f32(&result.m[4 * j], acc);
+    }
+#else
+    result = detail::mat4_mul_scalar(lhs, rhs);
+#endif
+    return result;
+}
 
-    Mat4 r_to_l = mat4_mul(rhs, lhs);
-    Mat4 r_to_l_expected(
-        63.f, 161.f, 123.f, 82.f,
-        53.f, 76.f, 57.f, 63.f,
-        68.f, 107.f, 69.f, 93.f,
-        128.f, 175.f, 117.f, 146.f
-    );
+static constexpr Vec4 mat4_mul(Mat4 const& m, Vec4 v)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::mat4_mul_scalar(m, v);
+    }
 
-    ASSERT(mat4_eq(r_to_l_expected, r_to_l));
+#if MATH_SSE
+    __m128 acc = _mm_mul_ps(_mm_load_ps(&m.m[0]), _mm_set1_ps(v.x));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_load_ps(&m.m[4]), _mm_set1_ps(v.y)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_load_ps(&m.m[8]), _mm_set1_ps(v.z)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_load_ps(&m.m[12]), _mm_set1_ps(v.w)));
+    return detail::vec4_store(acc);
+#elif MATH_NEON
+    float32x4_t vv = detail::vec4_load(v);
+    float32x4_t acc = vmulq_laneq_f32(vld1q_f32(&m.m[0]), vv, 0);
+    acc = vfmaq_laneq_f32(acc, vld1q_f32(&m.m[4]), vv, 1);
+    acc = vfmaq_laneq_f32(acc, vld1q_f32(&m.m[8]), vv, 2);
+    acc = vfmaq_laneq_f32(acc, vld1q_f32(&m.m[12]), vv, 3);
+    return detail::vec4_store(acc);
+#else
+    return detail::mat4_mul_scalar(m, v);
+#endif
 }
 
-static Mat4 mat4_translate(Vec3 translation)
+static constexpr Mat4 mat4_translate(Vec3 translation)
 {
     Mat4 result = mat4_identity();
-    result.m03 = translation.x;
-    result.m13 = translation.y;
-    result.m23 = translation.z;
+    result(0, 3) = translation.x;
+    result(1, 3) = translation.y;
+    result(2, 3) = translation.z;
     return result;
 }
 
-static Mat4 mat4_translate(f32 x, f32 y, f32 z)
+static constexpr Mat4 mat4_translate(f32 x, f32 y, f32 z)
 {
     return mat4_translate(Vec3{x, y, z});
 }
 
 namespace detail
 {
-    static Mat4 mat4_rotate_LH(Vec3 angles_rad)
+    static constexpr Mat4 mat4_rotate_LH(Vec3 angles_rad)
     {
-        f32 const A = cosf(angles_rad.x);
-        f32 const B = sinf(angles_rad.x);
-        f32 const C = cosf(angles_rad.y);
-        f32 const D = sinf(angles_rad.y);
-        f32 const E = cosf(angles_rad.z);
-        f32 const F = sinf(angles_rad.z);
+        Sin_Cos const x = sincos(angles_rad.x);
+        Sin_Cos const y = sincos(angles_rad.y);
+        Sin_Cos const z = sincos(angles_rad.z);
+        f32 const A = x.cos;
+        f32 const B = x.sin;
+        f32 const C = y.cos;
+        f32 const D = y.sin;
+        f32 const E = z.cos;
+        f32 const F = z.sin;
 
         return Mat4(
             C * E,             -C * F,             -D,     0.0f,
@@ -476,7 +854,7 @@ namespace detail
         );
     }
 
-    static Mat4 mat4_rotate_RH(Vec3 angles_rad)
+    static constexpr Mat4 mat4_rotate_RH(Vec3 angles_rad)
     {
         Vec3 flipped_angles = angles_rad;
         flipped_angles.y *= -1;
@@ -484,7 +862,7 @@ namespace detail
     }
 }
 
-static Mat4 mat4_rotate(Vec3 angles_rad)
+static constexpr Mat4 mat4_rotate(Vec3 angles_rad)
 {
     if constexpr (left_handed)
     {
@@ -496,7 +874,7 @@ static Mat4 mat4_rotate(Vec3 angles_rad)
     }
 }
 
-static Mat4 mat4_rotate(f32 rad_x, f32 rad_y, f32 rad_z)
+static constexpr Mat4 mat4_rotate(f32 rad_x, f32 rad_y, f32 rad_z)
 {
     return mat4_rotate(Vec3{rad_x, rad_y, rad_z});
 }
@@ -504,9 +882,10 @@ static Mat4 mat4_rotate(f32 rad_x, f32 rad_y, f32 rad_z)
 namespace detail
 {
     // note for future: http://perry.cz/articles/ProjectionMatrix.xhtml
-    static Mat4 mat4_perspective_LH(f32 vertical_fov_rad, f32 aspect_ratio, f32 near_z, f32 far_z)
+    static constexpr Mat4 mat4_perspective_LH(f32 vertical_fov_rad, f32 aspect_ratio, f32 near_z, f32 far_z)
     {
-        f32 g = 1.0f / tanf(vertical_fov_rad * 0.5f);
+        Sin_Cos half_fov = sincos(vertical_fov_rad * 0.5f);
+        f32 g = half_fov.cos / half_fov.sin;
 
         return Mat4(
             g / aspect_ratio, 0, 0, 0,
@@ -515,9 +894,10 @@ namespace detail
             0, 0, 1.f, 0.f);
     }
 
-    static Mat4 mat4_perspective_RH(f32 vertical_fov_rad, f32 aspect_ratio, f32 near_z, f32 far_z)
+    static constexpr Mat4 mat4_perspective_RH(f32 vertical_fov_rad, f32 aspect_ratio, f32 near_z, f32 far_z)
     {
-        f32 g = 1.0f / tanf(vertical_fov_rad * 0.5f);
+        Sin_Cos half_fov = sincos(vertical_fov_rad * 0.5f);
+        f32 g = half_fov.cos / half_fov.sin;
         f32 k = far_z / (far_z - near_z);
 
         return Mat4(
@@ -528,7 +908,7 @@ namespace detail
     }
 }
 
-static Mat4 mat4_perspective(f32 vertical_fov_rad, f32 aspect_ratio, f32 near_z, f32 far_z)
+static constexpr Mat4 mat4_perspective(f32 vertical_fov_rad, f32 aspect_ratio, f32 near_z, f32 far_z)
 {
     if constexpr (left_handed)
     {
@@ -540,25 +920,252 @@ static Mat4 mat4_perspective(f32 vertical_fov_rad, f32 aspect_ratio, f32 near_z,
     }
 }
 
-static Mat4 transpose(Mat4 const& m)
+static constexpr Mat4 transpose(Mat4 const& m)
 {
-    Mat4 out = m;
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::transpose_scalar(m);
+    }
 
-    for (int i = 0; i < 4; i++)
+#if MATH_SSE
+    __m128 c0 = _mm_load_ps(&m.m[0]);
+    __m128 c1 = _mm_load_ps(&m.m[4]);
+    __m128 c2 = _mm_load_ps(&m.m[8]);
+    __m128 c3 = _mm_load_ps(&m.m[12]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    Mat4 out;
+    _mm_store_ps(&out.m[0], c0);
+    _mm_store_ps(&out.m[4], c1);
+    _mm_store_ps(&out.m[8], c2);
+    _mm_store_ps(&out.m[12], c3);
+    return out;
+#elif MATH_NEON
+    // De-interleaving load: lane i of every column ends up in register i, i.e. row i.
+    float32x4x4_t rows = vld4q_f32(m.m);
+
+    Mat4 out;
+    vst1q_f32(&out.m[0], rows.val[0]);
+    vst1q_f32(&out.m[4], rows.val[1]);
+    vst1q_f32(&out.m[8], rows.val[2]);
+    vst1q_f32(&out.m[12], rows.val[3]);
+    return out;
+#else
+    return detail::transpose_scalar(m);
+#endif
+}
+
+namespace detail
+{
+    // Cofactor expansion over 2x2 sub-determinants of the top and bottom two rows.
+    static constexpr Mat4 mat4_inverse_scalar(Mat4 const& m)
     {
-        for (int j = i + 1; j < 4; j++)
-        {
-            f32 temp = out(i, j);
-            out(i, j) = out(j, i);
-            out(j, i) = temp;
-        }
+        f32 s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+        f32 s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+        f32 s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+        f32 s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+        f32 s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+        f32 s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+
+        f32 c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+        f32 c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+        f32 c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+        f32 c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+        f32 c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+        f32 c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+
+        f32 det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        ASSERT_DEBUG_MSG(det != 0.0f, "Inverting a singular matrix.");
+        f32 inv_det = 1.0f / det;
+
+        return Mat4(
+            ( m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3) * inv_det,
+            (-m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3) * inv_det,
+            ( m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3) * inv_det,
+            (-m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3) * inv_det,
+
+            (-m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1) * inv_det,
+            ( m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1) * inv_det,
+            (-m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1) * inv_det,
+            ( m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1) * inv_det,
+
+            ( m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0) * inv_det,
+            (-m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0) * inv_det,
+            ( m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0) * inv_det,
+            (-m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0) * inv_det,
+
+            (-m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0) * inv_det,
+            ( m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0) * inv_det,
+            (-m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0) * inv_det,
+            ( m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0) * inv_det);
+    }
+
+#if MATH_SSE
+    // 2x2 matrices stored as (m00, m01, m10, m11). adj(A) is the adjugate, inverse(A) * det(A).
+
+    // A * B
+    static inline __m128 mat2_mul(__m128 a, __m128 b)
+    {
+        return _mm_add_ps(
+            _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+
+    // adj(A) * B
+    static inline __m128 mat2_adj_mul(__m128 a, __m128 b)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    // A * adj(B)
+    static inline __m128 mat2_mul_adj(__m128 a, __m128 b)
+    {
+        return _mm_sub_ps(
+            _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+            _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
     }
+#endif
+}
+
+// General inverse, for projections and anything else without a known structure.
+// Prefer mat4_inverse_rigid or mat4_inverse_affine when they apply. The rigid inverse is the
+// cheapest everywhere; the affine one is at least as accurate, but only cheaper than this
+// where there is no SIMD version (NEON, scalar), see bench/bench_math.cpp.
+static constexpr Mat4 mat4_inverse(Mat4 const& m)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::mat4_inverse_scalar(m);
+    }
+
+#if MATH_SSE
+    // Block inverse of M = | A B |, built from 2x2 adjugates and determinants only.
+    //                      | C D |
+    // The blocks are read from the columns, which inverts the transpose and writes it
+    // back as columns, so the result comes out as inverse(M) directly.
+    __m128 c0 = _mm_load_ps(&m.m[0]);
+    __m128 c1 = _mm_load_ps(&m.m[4]);
+    __m128 c2 = _mm_load_ps(&m.m[8]);
+    __m128 c3 = _mm_load_ps(&m.m[12]);
+
+    __m128 a = _mm_movelh_ps(c0, c1);
+    __m128 b = _mm_movehl_ps(c1, c0);
+    __m128 c = _mm_movelh_ps(c2, c3);
+    __m128 d = _mm_movehl_ps(c3, c2);
+
+    // (det(A), det(B), det(C), det(D))
+    __m128 det_sub = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+        _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+    __m128 det_a = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 det_b = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 det_c = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 det_d = _mm_shuffle_ps(det_sub, det_sub, _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m128 d_c = detail::mat2_adj_mul(d, c);
+    __m128 a_b = detail::mat2_adj_mul(a, b);
+
+    // inverse(M) = 1 / det(M) * | adj(X) adj(Y) |
+    //                           | adj(Z) adj(W) |
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), detail::mat2_mul(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), detail::mat2_mul(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), detail::mat2_mul_adj(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), detail::mat2_mul_adj(a, d_c));
+
+    // det(M) = det(A) det(D) + det(B) det(C) - trace(adj(A) B adj(D) C)
+    __m128 trace = detail::hsum_ps(_mm_mul_ps(a_b, _mm_shuffle_ps(d_c, d_c, _MM_SHUFFLE(3, 1, 2, 0))));
+    __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), trace);
+    ASSERT_DEBUG_MSG(_mm_cvtss_f32(det) != 0.0f, "Inverting a singular matrix.");
+
+    // The adjugate sign pattern is folded into the reciprocal.
+    __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), det);
+    x = _mm_mul_ps(x, inv_det);
+    y = _mm_mul_ps(y, inv_det);
+    z = _mm_mul_ps(z, inv_det);
+    w = _mm_mul_ps(w, inv_det);
+
+    Mat4 out;
+    _mm_store_ps(&out.m[0], _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_store_ps(&out.m[4], _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_store_ps(&out.m[8], _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_store_ps(&out.m[12], _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
     return out;
+#else
+    // The block version needs a lot of cross lane shuffles, NEON does about as well with the scalar one.
+    return detail::mat4_inverse_scalar(m);
+#endif
+}
+
+// Inverse of a matrix whose bottom row is (0, 0, 0, 1), i.e. any mix of translation, rotation,
+// scale and shear. Only the 3x3 part needs inverting: its rows are cross products of its columns.
+static constexpr Mat4 mat4_inverse_affine(Mat4 const& m)
+{
+    Vec3 c0{ m(0, 0), m(1, 0), m(2, 0) };
+    Vec3 c1{ m(0, 1), m(1, 1), m(2, 1) };
+    Vec3 c2{ m(0, 2), m(1, 2), m(2, 2) };
+    Vec3 t{ m(0, 3), m(1, 3), m(2, 3) };
+
+    Vec3 r0 = cross(c1, c2);
+    Vec3 r1 = cross(c2, c0);
+    Vec3 r2 = cross(c0, c1);
+    f32 det = dot(c0, r0);
+    ASSERT_DEBUG_MSG(det != 0.0f, "Inverting a singular matrix.");
+    f32 inv_det = 1.0f / det;
+    r0 = r0 * inv_det;
+    r1 = r1 * inv_det;
+    r2 = r2 * inv_det;
+
+    return Mat4(
+        r0.x, r0.y, r0.z, -dot(r0, t),
+        r1.x, r1.y, r1.z, -dot(r1, t),
+        r2.x, r2.y, r2.z, -dot(r2, t),
+        0.f,  0.f,  0.f,  1.f);
+}
+
+// Inverse of a rotation followed by a translation, e.g. a camera's world transform.
+// The rotation has to be orthonormal, so no scale: its inverse is just the transpose.
+static constexpr Mat4 mat4_inverse_rigid(Mat4 const& m)
+{
+    Vec3 c0{ m(0, 0), m(1, 0), m(2, 0) };
+    Vec3 c1{ m(0, 1), m(1, 1), m(2, 1) };
+    Vec3 c2{ m(0, 2), m(1, 2), m(2, 2) };
+    Vec3 t{ m(0, 3), m(1, 3), m(2, 3) };
+
+    return Mat4(
+        c0.x, c0.y, c0.z, -dot(c0, t),
+        c1.x, c1.y, c1.z, -dot(c1, t),
+        c2.x, c2.y, c2.z, -dot(c2, t),
+        0.f,  0.f,  0.f,  1.f);
+}
+
+// transpose(inverse(m)) of the upper 3x3, which is what normals have to be transformed by
+// when m contains non-uniform scale. Translation doesn't apply to directions and is dropped.
+static constexpr Mat4 mat4_inverse_transpose(Mat4 const& m)
+{
+    Vec3 c0{ m(0, 0), m(1, 0), m(2, 0) };
+    Vec3 c1{ m(0, 1), m(1, 1), m(2, 1) };
+    Vec3 c2{ m(0, 2), m(1, 2), m(2, 2) };
+
+    // The columns of the inverse transpose are the rows of the inverse.
+    Vec3 r0 = cross(c1, c2);
+    Vec3 r1 = cross(c2, c0);
+    Vec3 r2 = cross(c0, c1);
+    f32 det = dot(c0, r0);
+    ASSERT_DEBUG_MSG(det != 0.0f, "Inverting a singular matrix.");
+    f32 inv_det = 1.0f / det;
+
+    return Mat4(
+        r0.x * inv_det, r1.x * inv_det, r2.x * inv_det, 0.f,
+        r0.y * inv_det, r1.y * inv_det, r2.y * inv_det, 0.f,
+        r0.z * inv_det, r1.z * inv_det, r2.z * inv_det, 0.f,
+        0.f,            0.f,            0.f,            1.f);
 }
 
 namespace detail
 {
-    static Mat4 mat4_look_to_lh(Vec3 eye_pos, Vec3 eye_dir, Vec3 up)
+    static constexpr Mat4 mat4_look_to_lh(Vec3 eye_pos, Vec3 eye_dir, Vec3 up)
     {
         Vec3 R2 = normalized(eye_dir);
         Vec3 R0 = normalized(cross(up, R2));
@@ -578,20 +1185,20 @@ namespace detail
         return m;
     }
 
-    static Mat4 mat4_look_at_lh(Vec3 cameraPos, Vec3 target, Vec3 up)
+    static constexpr Mat4 mat4_look_at_lh(Vec3 cameraPos, Vec3 target, Vec3 up)
     {
         Vec3 eye_dir = vec3_sub(target, cameraPos);
         return mat4_look_to_lh(cameraPos, eye_dir, up);
     }
 
-    static Mat4 mat4_look_at_rh(Vec3 cameraPos, Vec3 target, Vec3 up)
+    static constexpr Mat4 mat4_look_at_rh(Vec3 cameraPos, Vec3 target, Vec3 up)
     {
         Vec3 neg_eye_dir = vec3_sub(cameraPos, target);
         return mat4_look_to_lh(cameraPos, neg_eye_dir, up);
     }
 }
 
-static Mat4 mat4_look_at(Vec3 cameraPos, Vec3 target, Vec3 up)
+static constexpr Mat4 mat4_look_at(Vec3 cameraPos, Vec3 target, Vec3 up)
 {
     if constexpr (left_handed)
     {
@@ -601,4 +1208,608 @@ static Mat4 mat4_look_at(Vec3 cameraPos, Vec3 target, Vec3 up)
     {
         return detail::mat4_look_at_rh(cameraPos, target, up);
     }
-}
\ No newline at end of file
+}
+
+// Unit quaternions for rotations. v' = q * v * conjugate(q), composing a * b rotates by b first.
+struct Quat
+{
+    f32 x = 0.0f;
+    f32 y = 0.0f;
+    f32 z = 0.0f;
+    f32 w = 1.0f;
+};
+
+static constexpr Quat quat_identity()
+{
+    return Quat{ 0.f, 0.f, 0.f, 1.f };
+}
+
+// Rotation of angle_rad around a normalized axis.
+static constexpr Quat quat_from_axis_angle(Vec3 axis, f32 angle_rad)
+{
+    Sin_Cos half = sincos(angle_rad * 0.5f);
+    return Quat{ axis.x * half.sin, axis.y * half.sin, axis.z * half.sin, half.cos };
+}
+
+static constexpr Quat quat_conjugate(Quat q)
+{
+    return Quat{ -q.x, -q.y, -q.z, q.w };
+}
+
+static constexpr f32 quat_dot(Quat a, Quat b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+static constexpr Quat quat_normalized(Quat q)
+{
+    f32 inv_len = 1.0f / math_sqrt(quat_dot(q, q));
+    return Quat{ q.x * inv_len, q.y * inv_len, q.z * inv_len, q.w * inv_len };
+}
+
+namespace detail
+{
+    static constexpr Quat quat_mul_scalar(Quat a, Quat b)
+    {
+        return Quat {
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+            a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+        };
+    }
+}
+
+// Hamilton product. Written as a.w * b plus the other three components of a, each
+// scaling a shuffled and sign flipped copy of b.
+static constexpr Quat quat_mul(Quat a, Quat b)
+{
+    if (MATH_CONSTANT_EVALUATED())
+    {
+        return detail::quat_mul_scalar(a, b);
+    }
+
+#if MATH_SSE
+    __m128 va = _mm_loadu_ps(&a.x);
+    __m128 vb = _mm_loadu_ps(&b.x);
+    __m128 b_wzyx = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(0, 1, 2, 3));
+    __m128 b_zwxy = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128 b_yxwz = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 r = _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(3, 3, 3, 3)), vb);
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(0, 0, 0, 0)), _mm_mul_ps(b_wzyx, _mm_setr_ps(1.f, -1.f, 1.f, -1.f))));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(1, 1, 1, 1)), _mm_mul_ps(b_zwxy, _mm_setr_ps(1.f, 1.f, -1.f, -1.f))));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 2, 2, 2)), _mm_mul_ps(b_yxwz, _mm_setr_ps(-1.f, 1.f, 1.f, -1.f))));
+
+    Quat out;
+    _mm_storeu_ps(&out.x, r);
+    return out;
+#elif MATH_NEON
+    f32 const sign_wzyx[4] = { 1.f, -1.f, 1.f, -1.f };
+    f32 const sign_zwxy[4] = { 1.f, 1.f, -1.f, -1.f };
+    f32 const sign_yxwz[4] = { -1.f, 1.f, 1.f, -1.f };
+
+    float32x4_t va = vld1q_f32(&a.x);
+    float32x4_t vb = vld1q_f32(&b.x);
+    float32x4_t b_zwxy = vextq_f32(vb, vb, 2);
+    float32x4_t b_wzyx = vrev64q_f32(b_zwxy);
+    float32x4_t b_yxwz = vrev64q_f32(vb);
+    float32x4_t r = vmulq_laneq_f32(vb, va, 3);
+    r = vfmaq_laneq_f32(r, vmulq_f32(b_wzyx, vld1q_f32(sign_wzyx)), va, 0);
+    r = vfmaq_laneq_f32(r, vmulq_f32(b_zwxy, vld1q_f32(sign_zwxy)), va, 1);
+    r = vfmaq_laneq_f32(r, vmulq_f32(b_yxwz, vld1q_f32(sign_yxwz)), va, 2);
+
+    Quat out;
+    vst1q_f32(&out.x, r);
+    return out;
+#else
+    return detail::quat_mul_scalar(a, b);
+#endif
+}
+
+static constexpr Vec3 quat_rotate(Quat q, Vec3 v)
+{
+    // v + 2w (q.xyz x v) + 2 q.xyz x (q.xyz x v), which avoids building the full sandwich product.
+    Vec3 u{ q.x, q.y, q.z };
+    Vec3 t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+}
+
+// Normalized linear interpolation, t = 0 returns a. Cheap and good enough for
+// small angles, e.g. blending neighbouring animation keys.
+static constexpr Quat quat_nlerp(Quat a, Quat b, f32 t)
+{
+    // Take the shorter way around, q and -q are the same rotation.
+    f32 sign = quat_dot(a, b) < 0.f ? -1.f : 1.f;
+    f32 ta = 1.f - t;
+    f32 tb = t * sign;
+    return quat_normalized(Quat{ a.x * ta + b.x * tb, a.y * ta + b.y * tb, a.z * ta + b.z * tb, a.w * ta + b.w * tb });
+}
+
+// Spherical interpolation at constant angular velocity, t = 0 returns a.
+static Quat quat_slerp(Quat a, Quat b, f32 t)
+{
+    f32 cos_theta = quat_dot(a, b);
+    f32 sign = 1.f;
+    if (cos_theta < 0.f)
+    {
+        cos_theta = -cos_theta;
+        sign = -1.f;
+    }
+
+    // Nearly identical rotations make sin(theta) tiny, nlerp is indistinguishable there.
+    if (cos_theta > 0.9995f)
+    {
+        return quat_nlerp(a, b, t);
+    }
+
+    f32 theta = acosf(cos_theta);
+    f32 inv_sin_theta = 1.f / sinf(theta);
+    f32 ta = sinf((1.f - t) * theta) * inv_sin_theta;
+    f32 tb = sinf(t * theta) * inv_sin_theta * sign;
+    return Quat{ a.x * ta + b.x * tb, a.y * ta + b.y * tb, a.z * ta + b.z * tb, a.w * ta + b.w * tb };
+}
+
+static constexpr Mat4 mat4_from_quat(Quat q)
+{
+    f32 xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    f32 xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    f32 wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    return Mat4(
+        1.f - 2.f * (yy + zz), 2.f * (xy - wz),       2.f * (xz + wy),       0.f,
+        2.f * (xy + wz),       1.f - 2.f * (xx + zz), 2.f * (yz - wx),       0.f,
+        2.f * (xz - wy),       2.f * (yz + wx),       1.f - 2.f * (xx + yy), 0.f,
+        0.f,                   0.f,                   0.f,                   1.f);
+}
+
+// Translation, rotation and scale, applied to points in the order scale, rotate, translate.
+// Composing in this form is cheaper than multiplying 4x4 matrices and keeps the rotation
+// orthonormal. It is only exact for uniform scales though: a non-uniform scale on a parent
+// followed by a rotated child would need shear, which TRS can't express.
+struct Transform
+{
+    Vec3 translation = { 0.f, 0.f, 0.f };
+    Quat rotation = {};
+    Vec3 scale = { 1.f, 1.f, 1.f };
+};
+
+static constexpr Transform transform_identity()
+{
+    return Transform{};
+}
+
+static constexpr Vec3 transform_point(Transform const& t, Vec3 p)
+{
+    return quat_rotate(t.rotation, p * t.scale) + t.translation;
+}
+
+// The transform that applies child first and then parent, e.g. local to world for a node in a hierarchy.
+static constexpr Transform transform_mul(Transform const& parent, Transform const& child)
+{
+    Transform result;
+    result.translation = transform_point(parent, child.translation);
+    result.rotation = quat_mul(parent.rotation, child.rotation);
+    result.scale = parent.scale * child.scale;
+    return result;
+}
+
+static constexpr Transform transform_inverse(Transform const& t)
+{
+    Transform result;
+    result.rotation = quat_conjugate(t.rotation);
+    result.scale = Vec3{ 1.f / t.scale.x, 1.f / t.scale.y, 1.f / t.scale.z };
+    result.translation = quat_rotate(result.rotation, -t.translation) * result.scale;
+    return result;
+}
+
+// Same as mat4_translate(t) * mat4_from_quat(r) * scale(s), without the multiplies.
+static constexpr Mat4 mat4_from_transform(Transform const& t)
+{
+    Mat4 result = mat4_from_quat(t.rotation);
+    for (u32 row = 0; row < 3; ++row)
+    {
+        result(row, 0) *= t.scale.x;
+        result(row, 1) *= t.scale.y;
+        result(row, 2) *= t.scale.z;
+    }
+    result(0, 3) = t.translation.x;
+    result(1, 3) = t.translation.y;
+    result(2, 3) = t.translation.z;
+    return result;
+}
+
+// Axis aligned bounding box. An empty box has min > max, so the first point added fixes it.
+struct AABB
+{
+    Vec3 min = { 3.402823466e+38f, 3.402823466e+38f, 3.402823466e+38f };
+    Vec3 max = { -3.402823466e+38f, -3.402823466e+38f, -3.402823466e+38f };
+};
+
+static constexpr AABB aabb_add(AABB box, Vec3 p)
+{
+    box.min = Vec3{ p.x < box.min.x ? p.x : box.min.x, p.y < box.min.y ? p.y : box.min.y, p.z < box.min.z ? p.z : box.min.z };
+    box.max = Vec3{ p.x > box.max.x ? p.x : box.max.x, p.y > box.max.y ? p.y : box.max.y, p.z > box.max.z ? p.z : box.max.z };
+    return box;
+}
+
+static constexpr Vec3 aabb_center(AABB const& box)
+{
+    return (box.min + box.max) * 0.5f;
+}
+
+static constexpr Vec3 aabb_half_extent(AABB const& box)
+{
+    return (box.max - box.min) * 0.5f;
+}
+
+// Bounding sphere. An empty sphere has a negative radius, so the first point added fixes it.
+struct Sphere
+{
+    Vec3 center;
+    f32 radius = -1.0f;
+};
+
+// Ritter's growth step: if p is outside, moves the center towards p just far enough for
+// the new sphere to touch p and still contain the old one.
+static constexpr Sphere sphere_add(Sphere s, Vec3 p)
+{
+    if (s.radius < 0.0f)
+    {
+        return Sphere{ p, 0.0f };
+    }
+
+    Vec3 d = p - s.center;
+    f32 dist_sq = dot(d, d);
+    if (dist_sq <= s.radius * s.radius)
+    {
+        return s;
+    }
+
+    f32 dist = math_sqrt(dist_sq);
+    f32 radius = (s.radius + dist) * 0.5f;
+    s.center = s.center + d * ((radius - s.radius) / dist);
+    s.radius = radius;
+    return s;
+}
+
+// Bounds of the transformed sphere. Non uniform scale grows the radius by the largest axis scale.
+static constexpr Sphere sphere_transform(Mat4 const& m, Sphere s)
+{
+    Vec4 c = mat4_mul(m, Vec4{ s.center.x, s.center.y, s.center.z, 1.0f });
+    f32 scale_sq = 0.0f;
+    for (u32 col = 0; col < 3; ++col)
+    {
+        scale_sq = math_max(scale_sq, m(0, col) * m(0, col) + m(1, col) * m(1, col) + m(2, col) * m(2, col));
+    }
+    return Sphere{ Vec3{ c.x, c.y, c.z }, s.radius * math_sqrt(scale_sq) };
+}
+
+enum class Frustum_Plane : u8
+{
+    LEFT,
+    RIGHT,
+    BOTTOM,
+    TOP,
+    NEAR,
+    FAR,
+    COUNT,
+};
+
+// Planes as (normal, distance) with unit normals pointing inwards, so dot(normal, p) + distance
+// is the signed distance of p to the plane and positive on the inside.
+struct Frustum
+{
+    Vec4 planes[u32(Frustum_Plane::COUNT)];
+};
+
+namespace detail
+{
+    static constexpr Vec4 plane_normalized(f32 x, f32 y, f32 z, f32 w)
+    {
+        f32 len = math_sqrt(x * x + y * y + z * z);
+        return Vec4{ x / len, y / len, z / len, w / len };
+    }
+
+    static constexpr Vec4 plane_from_rows(Mat4 const& m, u32 row, f32 sign)
+    {
+        return plane_normalized(
+            m(3, 0) + sign * m(row, 0),
+            m(3, 1) + sign * m(row, 1),
+            m(3, 2) + sign * m(row, 2),
+            m(3, 3) + sign * m(row, 3));
+    }
+}
+
+// Gribb and Hartmann: with clip = view_projection * (p, 1), the clip space bounds -w <= x <= w,
+// -w <= y <= w and 0 <= z <= w (Vulkan's depth range) are each a plane in the space p is in.
+// Pass projection * view for world space planes, works with either handedness.
+static constexpr Frustum frustum_from_matrix(Mat4 const& view_projection)
+{
+    Mat4 const& m = view_projection;
+    Frustum f;
+    f.planes[u32(Frustum_Plane::LEFT)] = detail::plane_from_rows(m, 0, 1.0f);
+    f.planes[u32(Frustum_Plane::RIGHT)] = detail::plane_from_rows(m, 0, -1.0f);
+    f.planes[u32(Frustum_Plane::BOTTOM)] = detail::plane_from_rows(m, 1, 1.0f);
+    f.planes[u32(Frustum_Plane::TOP)] = detail::plane_from_rows(m, 1, -1.0f);
+    f.planes[u32(Frustum_Plane::NEAR)] = detail::plane_normalized(m(2, 0), m(2, 1), m(2, 2), m(2, 3));
+    f.planes[u32(Frustum_Plane::FAR)] = detail::plane_from_rows(m, 2, -1.0f);
+    return f;
+}
+
+static constexpr f32 plane_distance(Vec4 plane, Vec3 p)
+{
+    return plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w;
+}
+
+// The tests below are conservative: false means the volume is entirely outside one of the
+// planes, true means it may be visible. Volumes near a frustum corner can pass while outside.
+static constexpr bool frustum_test_sphere(Frustum const& frustum, Sphere const& sphere)
+{
+    for (Vec4 plane : frustum.planes)
+    {
+        if (plane_distance(plane, sphere.center) < -sphere.radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static constexpr bool frustum_test_aabb(Frustum const& frustum, AABB const& box)
+{
+    Vec3 center = aabb_center(box);
+    Vec3 half_extent = aabb_half_extent(box);
+    for (Vec4 plane : frustum.planes)
+    {
+        // Projected radius of the box onto the plane normal.
+        f32 radius = math_abs(plane.x) * half_extent.x + math_abs(plane.y) * half_extent.y + math_abs(plane.z) * half_extent.z;
+        if (plane_distance(plane, center) < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Self-tests. The constexpr ones are checked by the static_asserts below, a failing ASSERT
+// calls handle_assert which isn't constexpr and turns into a compile error at that line.
+// Constant evaluation only sees the scalar paths, test_math_runtime covers the rest.
+
+static constexpr bool test_mat4_mul()
+{
+    Mat4 lhs(
+        1.f, 8.f, 4.f, 5.f,
+        6.f, 2.f, 1.f, 7.f,
+        3.f, 9.f, 9.f, 2.f,
+        8.f, 6.f, 4.f, 5.f
+    );
+
+    Mat4 rhs(
+        8.f, 2.f, 9.f, 2.f,
+        3.f, 5.f, 4.f, 1.f,
+        7.f, 6.f, 3.f, 2.f,
+        9.f, 8.f, 5.f, 7.f
+    );
+
+    Mat4 l_to_r = mat4_mul(lhs, rhs);
+    Mat4 l_to_r_expected(
+        105.f, 106.f, 78.f, 53.f,
+        124.f, 84.f, 100.f, 65.f,
+        132.f, 121.f, 100.f, 47.f,
+        155.f, 110.f, 133.f, 65.f
+    );
+
+    ASSERT(mat4_eq(l_to_r_expected, l_to_r));
+
+    Mat4 r_to_l = mat4_mul(rhs, lhs);
+    Mat4 r_to_l_expected(
+        63.f, 161.f, 123.f, 82.f,
+        53.f, 76.f, 57.f, 63.f,
+        68.f, 107.f, 69.f, 93.f,
+        128.f, 175.f, 117.f, 146.f
+    );
+
+    ASSERT(mat4_eq(r_to_l_expected, r_to_l));
+    return true;
+}
+
+static constexpr bool test_mat4_inverse()
+{
+    // Products with the inverse land within a few ulps of identity for well conditioned inputs.
+    f32 const epsilon = 1e-5f;
+
+    Mat4 general(
+        1.f, 8.f, 4.f, 5.f,
+        6.f, 2.f, 1.f, 7.f,
+        3.f, 9.f, 9.f, 2.f,
+        8.f, 6.f, 4.f, 5.f
+    );
+    Mat4 general_inv = mat4_inverse(general);
+    ASSERT(mat4_approx_eq(mat4_mul(general, general_inv), mat4_identity(), epsilon));
+    ASSERT(mat4_approx_eq(mat4_mul(general_inv, general), mat4_identity(), epsilon));
+
+    Mat4 projection = mat4_perspective(1.2f, 16.0f / 9.0f, 0.1f, 100.0f);
+    ASSERT(mat4_approx_eq(mat4_mul(projection, mat4_inverse(projection)), mat4_identity(), epsilon));
+
+    Quat rotation = quat_from_axis_angle(normalized(Vec3{ 0.2f, -1.f, 0.4f }), 2.3f);
+    Mat4 affine = mat4_from_transform(Transform{ Vec3{ 3.f, -1.5f, 12.f }, rotation, Vec3{ 0.5f, 2.f, 4.f } });
+    Mat4 affine_inv = mat4_inverse_affine(affine);
+    ASSERT(mat4_approx_eq(affine_inv, mat4_inverse(affine), epsilon));
+    ASSERT(mat4_approx_eq(mat4_mul(affine, affine_inv), mat4_identity(), epsilon));
+
+    Mat4 rigid = mat4_from_transform(Transform{ Vec3{ -7.f, 0.25f, 3.f }, rotation, Vec3{ 1.f, 1.f, 1.f } });
+    Mat4 rigid_inv = mat4_inverse_rigid(rigid);
+    ASSERT(mat4_approx_eq(rigid_inv, mat4_inverse(rigid), epsilon));
+    ASSERT(mat4_approx_eq(mat4_mul(rigid, rigid_inv), mat4_identity(), epsilon));
+
+    Mat4 normal_matrix = mat4_inverse_transpose(affine);
+    Mat4 normal_matrix_expected = transpose(affine_inv);
+    normal_matrix_expected(3, 0) = 0.f;
+    normal_matrix_expected(3, 1) = 0.f;
+    normal_matrix_expected(3, 2) = 0.f;
+    ASSERT(mat4_approx_eq(normal_matrix, normal_matrix_expected, epsilon));
+    return true;
+}
+
+static constexpr bool test_quat_transform()
+{
+    Quat qa = quat_from_axis_angle(normalized(Vec3{ 1.f, 2.f, -0.5f }), 0.7f);
+    Quat qb = quat_from_axis_angle(normalized(Vec3{ -0.3f, 0.1f, 1.f }), -2.1f);
+
+    // Composing quaternions has to match multiplying their matrices.
+    Quat ab = quat_mul(qa, qb);
+    ASSERT(mat4_approx_eq(mat4_from_quat(ab), mat4_mul(mat4_from_quat(qa), mat4_from_quat(qb)), 1e-5f));
+
+    Vec3 p{ 0.25f, -4.f, 3.f };
+    Vec4 p_mat = mat4_mul(mat4_from_quat(qa), Vec4{ p.x, p.y, p.z, 1.f });
+    Vec3 p_quat = quat_rotate(qa, p);
+    ASSERT(math_abs(p_mat.x - p_quat.x) <= 1e-5f && math_abs(p_mat.y - p_quat.y) <= 1e-5f && math_abs(p_mat.z - p_quat.z) <= 1e-5f);
+
+    Transform parent{ Vec3{ 1.f, -2.f, 5.f }, qa, Vec3{ 2.f, 2.f, 2.f } };
+    Transform child{ Vec3{ 0.5f, 0.f, -1.f }, qb, Vec3{ 1.f, 3.f, 0.5f } };
+    Mat4 composed = mat4_from_transform(transform_mul(parent, child));
+    ASSERT(mat4_approx_eq(composed, mat4_mul(mat4_from_transform(parent), mat4_from_transform(child)), 1e-5f));
+
+    Transform round_trip = transform_mul(transform_inverse(parent), parent);
+    ASSERT(mat4_approx_eq(mat4_from_transform(round_trip), mat4_identity(), 1e-5f));
+
+    // Halfway between two rotations around the same axis is the rotation by the mean angle.
+    Vec3 axis = normalized(Vec3{ 0.f, 1.f, 1.f });
+    Quat half = quat_nlerp(quat_from_axis_angle(axis, 0.2f), quat_from_axis_angle(axis, 1.4f), 0.5f);
+    ASSERT(math_abs(quat_dot(half, quat_from_axis_angle(axis, 0.8f))) >= 1.f - 1e-6f);
+    return true;
+}
+
+static constexpr bool test_sincos()
+{
+    // Sampled across several periods, including both signs and the quadrant boundaries.
+    for (int i = -400; i <= 400; ++i)
+    {
+        f32 x = f32(i) * 0.0785398163f;
+        Sin_Cos high = sincos(x, Trig_Accuracy::HIGH);
+        Sin_Cos low = sincos(x, Trig_Accuracy::LOW);
+        f32 sin_x = f32(detail::sin_series(f64(x)));
+        f32 cos_x = f32(detail::cos_series(f64(x)));
+        ASSERT(math_abs(high.sin - sin_x) <= 2e-7f && math_abs(high.cos - cos_x) <= 2e-7f);
+        ASSERT(math_abs(low.sin - sin_x) <= 4e-5f && math_abs(low.cos - cos_x) <= 4e-5f);
+    }
+    return true;
+}
+
+static constexpr bool test_frustum()
+{
+    Vec3 eye = { 0.f, 2.f, -10.f };
+    Vec3 target = { 0.f, 2.f, 0.f };
+    Mat4 vp = mat4_mul(mat4_perspective(degree_to_rad(90.f), 1.f, 0.1f, 100.f), mat4_look_at(eye, target, Vec3{ 0.f, 1.f, 0.f }));
+    Frustum f = frustum_from_matrix(vp);
+
+    // Each corner of the clip space box maps onto three of the planes and inside the others.
+    // The tolerance covers the precision the inverse loses at the far plane.
+    Mat4 inv_vp = mat4_inverse(vp);
+    for (u32 i = 0; i < 8; ++i)
+    {
+        Vec4 clip = { (i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : 0.f, 1.f };
+        Vec4 corner = mat4_mul(inv_vp, clip);
+        Vec3 p = Vec3{ corner.x, corner.y, corner.z } * (1.f / corner.w);
+        u32 touching = 0;
+        for (Vec4 plane : f.planes)
+        {
+            f32 dist = plane_distance(plane, p);
+            ASSERT(dist >= -1e-2f);
+            touching += (dist < 1e-2f) ? 1 : 0;
+        }
+        ASSERT(touching == 3);
+    }
+
+    ASSERT(frustum_test_sphere(f, Sphere{ target, 0.5f }));
+    ASSERT(!frustum_test_sphere(f, Sphere{ eye - Vec3{ 0.f, 0.f, 1.f }, 0.5f }));   // Behind the camera.
+    ASSERT(!frustum_test_sphere(f, Sphere{ Vec3{ 0.f, 2.f, 95.f }, 4.f }));        // Past the far plane.
+    ASSERT(frustum_test_sphere(f, Sphere{ Vec3{ 0.f, 2.f, 95.f }, 6.f }));
+    ASSERT(!frustum_test_sphere(f, Sphere{ Vec3{ -20.f, 2.f, 0.f }, 5.f }));       // Left of the 90 degree fov.
+    ASSERT(frustum_test_aabb(f, AABB{ Vec3{ -20.f, 0.f, -1.f }, Vec3{ -9.f, 1.f, 1.f } }));
+    ASSERT(!frustum_test_aabb(f, AABB{ Vec3{ -20.f, 0.f, -1.f }, Vec3{ -12.f, 1.f, 1.f } }));
+
+    Transform t = { Vec3{ 1.f, 2.f, 3.f }, quat_identity(), Vec3{ 1.f, 3.f, 2.f } };
+    Sphere moved = sphere_transform(mat4_from_transform(t), Sphere{ Vec3{ 1.f, 1.f, 1.f }, 2.f });
+    ASSERT(moved.center.x == 2.f && moved.center.y == 5.f && moved.center.z == 5.f && moved.radius == 6.f);
+    return true;
+}
+
+static_assert(test_mat4_mul());
+static_assert(test_mat4_inverse());
+static_assert(test_quat_transform());
+static_assert(test_sincos());
+static_assert(test_frustum());
+
+// The SIMD kernels against their scalar references, and whatever needs <math.h>.
+// Runs at the start of bench_math, the optimized build that covers the SIMD paths release builds
+// use, so the editor's startup does no math self-checks.
+static inline void test_math_runtime()
+{
+    ASSERT(test_mat4_mul());
+    ASSERT(test_mat4_inverse());
+    ASSERT(test_quat_transform());
+    ASSERT(test_sincos());
+    ASSERT(test_frustum());
+
+    Mat4 lhs(
+        1.f, 8.f, 4.f, 5.f,
+        6.f, 2.f, 1.f, 7.f,
+        3.f, 9.f, 9.f, 2.f,
+        8.f, 6.f, 4.f, 5.f
+    );
+
+    Mat4 rhs(
+        8.f, 2.f, 9.f, 2.f,
+        3.f, 5.f, 4.f, 1.f,
+        7.f, 6.f, 3.f, 2.f,
+        9.f, 8.f, 5.f, 7.f
+    );
+
+    // The SIMD kernels have to agree with the scalar reference, up to rounding differences
+    // from summation order and fused multiply-adds.
+    ASSERT(mat4_approx_eq(detail::mat4_mul_scalar(lhs, rhs), mat4_mul(lhs, rhs)));
+    ASSERT(mat4_approx_eq(detail::mat4_mul_scalar(rhs, lhs), mat4_mul(rhs, lhs)));
+
+    // Matrices inside arrays and structs are often only 16 byte aligned, the AVX path must not
+    // assume more than that.
+    alignas(32) u8 misaligned[16 + 3 * sizeof(Mat4)];
+    Mat4* misaligned_mats = (Mat4*)(misaligned + 16);
+    misaligned_mats[0] = lhs;
+    misaligned_mats[1] = rhs;
+    misaligned_mats[2] = mat4_mul(misaligned_mats[0], misaligned_mats[1]);
+    ASSERT(mat4_approx_eq(detail::mat4_mul_scalar(lhs, rhs), misaligned_mats[2]));
+    ASSERT(mat4_eq(detail::transpose_scalar(lhs), transpose(lhs)));
+    ASSERT(mat4_approx_eq(detail::mat4_inverse_scalar(lhs), mat4_inverse(lhs), 1e-5f));
+
+    Mat4 view = mat4_mul(mat4_rotate(0.3f, -1.2f, 2.5f), mat4_translate(1.5f, -2.0f, 7.25f));
+    Mat4 mvp = mat4_mul(mat4_perspective(1.2f, 16.0f / 9.0f, 0.1f, 100.0f), view);
+    ASSERT(mat4_approx_eq(detail::mat4_mul_scalar(mat4_perspective(1.2f, 16.0f / 9.0f, 0.1f, 100.0f), view), mvp));
+
+    Vec4 a{ 0.5f, -3.0f, 2.25f, 1.0f };
+    Vec4 b{ -1.75f, 0.125f, 4.0f, 0.0f };
+    Vec4 mv = mat4_mul(mvp, a);
+    Vec4 mv_expected = detail::mat4_mul_scalar(mvp, a);
+    Vec4 c = cross(a, b);
+    Vec4 c_expected = detail::cross_scalar(a, b);
+    Vec4 n = normalized(a);
+    Vec4 n_expected = detail::normalized_scalar(a);
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT(fabsf(mv.get_unchecked(i) - mv_expected.get_unchecked(i)) <= 1e-5f * fmaxf(1.0f, fabsf(mv_expected.get_unchecked(i))));
+        ASSERT(c.get_unchecked(i) == c_expected.get_unchecked(i));
+        ASSERT(fabsf(n.get_unchecked(i) - n_expected.get_unchecked(i)) <= 1e-6f);
+    }
+    ASSERT(fabsf(dot(a, b) - detail::dot_scalar(a, b)) <= 1e-6f * fabsf(detail::dot_scalar(a, b)));
+
+    Quat qa = quat_from_axis_angle(normalized(Vec3{ 1.f, 2.f, -0.5f }), 0.7f);
+    Quat qb = quat_from_axis_angle(normalized(Vec3{ -0.3f, 0.1f, 1.f }), -2.1f);
+    Quat ab = quat_mul(qa, qb);
+    Quat ab_expected = detail::quat_mul_scalar(qa, qb);
+    ASSERT(fabsf(ab.x - ab_expected.x) <= 1e-6f && fabsf(ab.y - ab_expected.y) <= 1e-6f &&
+           fabsf(ab.z - ab_expected.z) <= 1e-6f && fabsf(ab.w - ab_expected.w) <= 1e-6f);
+
+    Vec3 axis = normalized(Vec3{ 0.f, 1.f, 1.f });
+    Quat half = quat_slerp(quat_from_axis_angle(axis, 0.2f), quat_from_axis_angle(axis, 1.4f), 0.5f);
+    ASSERT(fabsf(quat_dot(half, quat_from_axis_angle(axis, 0.8f))) >= 1.f - 1e-6f);
+}
@@ -1,57 +1,936 @@
 #include "memory.h"
 
-Arena arena_allocate(u64 capacity)
+#if ARENA_TRACKING
+#include "hash_map.h"
+#endif
+
+#if PLATFORM_WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#elif PLATFORM_OSX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// How arena snapshots copy their pages, see arena_snapshot_create.
+#if PLATFORM_OSX
+#include <mach/mach.h>
+#define ARENA_SNAPSHOT_VM_COPY 1
+#else
+#define ARENA_SNAPSHOT_VM_COPY 0
+#endif
+
+static u64 get_page_size()
+{
+    static u64 page_size = 0;
+    if (page_size == 0)
+    {
+#if PLATFORM_WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        page_size = info.dwPageSize;
+#else
+        page_size = (u64)sysconf(_SC_PAGESIZE);
+#endif
+    }
+    return page_size;
+}
+
+static u64 align_up(u64 value, u64 alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void* reserve_pages(u64 num_bytes)
+{
+#if PLATFORM_WIN32
+    return VirtualAlloc(nullptr, num_bytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* result = mmap(nullptr, num_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    return (result == MAP_FAILED) ? nullptr : result;
+#endif
+}
+
+// Reserves a range that starts on a huge page boundary, so the kernel can back it with huge pages.
+static void* reserve_pages_huge_aligned(u64 num_bytes)
+{
+#if PLATFORM_WIN32
+    // Large pages on windows have to be committed up front, which defeats committing on demand.
+    UNUSED_VAR(num_bytes);
+    return nullptr;
+#else
+    u64 padded_size = num_bytes + C_ARENA_HUGE_PAGE_SIZE;
+    u8* padded = (u8*)reserve_pages(padded_size);
+    if (!padded)
+    {
+        return nullptr;
+    }
+
+    // Trim the unaligned head and whatever is left over at the tail.
+    u8* aligned = (u8*)align_up(uintptr_t(padded), C_ARENA_HUGE_PAGE_SIZE);
+    u64 head = aligned - padded;
+    u64 tail = padded_size - head - num_bytes;
+    if (head)
+    {
+        munmap(padded, head);
+    }
+    if (tail)
+    {
+        munmap(aligned + num_bytes, tail);
+    }
+    return aligned;
+#endif
+}
+
+static void* reserve_explicit_huge_pages(u64 num_bytes)
+{
+#if defined(MAP_HUGETLB)
+    // Without MAP_NORESERVE the kernel claims pages from the huge page pool for the whole range
+    // up front. That makes the mapping fail right here if the pool is too small, instead of
+    // raising SIGBUS on first touch. Size the reserve of explicit huge page arenas accordingly.
+    void* result = mmap(nullptr, num_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_HUGETLB, -1, 0);
+    return (result == MAP_FAILED) ? nullptr : result;
+#else
+    UNUSED_VAR(num_bytes);
+    return nullptr;
+#endif
+}
+
+static bool advise_transparent_huge_pages(void* address, u64 num_bytes)
+{
+#if defined(MADV_HUGEPAGE)
+    return madvise(address, num_bytes, MADV_HUGEPAGE) == 0;
+#else
+    UNUSED_VAR(address);
+    UNUSED_VAR(num_bytes);
+    return false;
+#endif
+}
+
+static bool commit_pages(void* address, u64 num_bytes)
+{
+#if PLATFORM_WIN32
+    return VirtualAlloc(address, num_bytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    return mprotect(address, num_bytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+static void decommit_pages(void* address, u64 num_bytes, Arena_Flags flags)
+{
+#if PLATFORM_WIN32
+    UNUSED_VAR(flags);
+    VirtualFree(address, num_bytes, MEM_DECOMMIT);
+#else
+    // Mapping fresh PROT_NONE pages over the range drops the physical pages and
+    // guarantees they read back as zero once they are committed again.
+    mmap(address, num_bytes, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_FIXED, -1, 0);
+
+    // The new mapping doesn't inherit the advice given to the old one.
+    if (is_set(flags, Arena_Flags::TRANSPARENT_HUGE_PAGES))
+    {
+        advise_transparent_huge_pages(address, num_bytes);
+    }
+#endif
+}
+
+static void release_pages(void* address, u64 num_bytes)
+{
+#if PLATFORM_WIN32
+    UNUSED_VAR(num_bytes);
+    VirtualFree(address, 0, MEM_RELEASE);
+#else
+    munmap(address, num_bytes);
+#endif
+}
+
+#if ARENA_TRACKING
+struct Arena_Callsite_Key
+{
+    char const* file = nullptr;
+    u64 line = 0; // u64 so the key has no padding bytes that would be hashed.
+};
+
+struct Arena_Callsite_Stats
+{
+    u64 bytes_pushed = 0;
+    u64 num_pushes = 0;
+};
+
+struct Arena_Stats
+{
+    u64 peak_bytes_allocated = 0;
+    u64 peak_bytes_committed = 0;
+    u64 total_bytes_pushed = 0;
+    u64 total_pushes = 0;
+
+    u64 frame_bytes_pushed = 0;
+    u64 frame_pushes = 0;
+    u64 frame_peak_bytes_allocated = 0;
+    u64 reported_peak_bytes_allocated = 0;
+
+    // Heap backed, so the bookkeeping never shows up in the arena it describes.
+    Hash_Map<Arena_Callsite_Key, Arena_Callsite_Stats> callsites;
+};
+
+static void arena_track_push(Arena* arena, u64 num_bytes, Source_Location loc)
+{
+    Arena_Stats* stats = arena->stats;
+    if (!stats)
+    {
+        stats = (Arena_Stats*)malloc(sizeof(Arena_Stats));
+        *stats = Arena_Stats{};
+        stats->callsites = hash_map_create<Arena_Callsite_Key, Arena_Callsite_Stats>(nullptr, 64);
+        arena->stats = stats;
+    }
+
+    stats->total_bytes_pushed += num_bytes;
+    stats->total_pushes += 1;
+    stats->frame_bytes_pushed += num_bytes;
+    stats->frame_pushes += 1;
+
+    if (arena->bytes_allocated > stats->peak_bytes_allocated)
+    {
+        stats->peak_bytes_allocated = arena->bytes_allocated;
+    }
+    if (arena->bytes_allocated > stats->frame_peak_bytes_allocated)
+    {
+        stats->frame_peak_bytes_allocated = arena->bytes_allocated;
+    }
+    if (arena->bytes_committed > stats->peak_bytes_committed)
+    {
+        stats->peak_bytes_committed = arena->bytes_committed;
+    }
+
+    Arena_Callsite_Stats* callsite = hash_map_find_or_add(&stats->callsites, Arena_Callsite_Key{loc.file, loc.line});
+    callsite->bytes_pushed += num_bytes;
+    callsite->num_pushes += 1;
+}
+
+static void arena_destroy_stats(Arena* arena)
+{
+    if (arena->stats)
+    {
+        hash_map_destroy(&arena->stats->callsites);
+        free(arena->stats);
+        arena->stats = nullptr;
+    }
+}
+
+Arena_Frame_Summary arena_stats_end_frame(Arena* arena)
+{
+    Arena_Frame_Summary summary;
+    Arena_Stats* stats = arena->stats;
+    if (!stats)
+    {
+        return summary;
+    }
+
+    summary.bytes_pushed = stats->frame_bytes_pushed;
+    summary.num_pushes = stats->frame_pushes;
+    summary.peak_bytes_allocated = stats->frame_peak_bytes_allocated;
+    summary.is_new_high_water_mark = stats->peak_bytes_allocated > stats->reported_peak_bytes_allocated;
+
+    stats->reported_peak_bytes_allocated = stats->peak_bytes_allocated;
+    stats->frame_bytes_pushed = 0;
+    stats->frame_pushes = 0;
+    stats->frame_peak_bytes_allocated = arena->bytes_allocated;
+
+    return summary;
+}
+
+static int compare_callsites_by_bytes(void const* lhs, void const* rhs)
+{
+    auto const* l = (Hash_Map_Slot<Arena_Callsite_Key, Arena_Callsite_Stats> const*)lhs;
+    auto const* r = (Hash_Map_Slot<Arena_Callsite_Key, Arena_Callsite_Stats> const*)rhs;
+    if (l->value.bytes_pushed == r->value.bytes_pushed)
+    {
+        return 0;
+    }
+    return (l->value.bytes_pushed < r->value.bytes_pushed) ? 1 : -1;
+}
+
+void arena_stats_dump(Arena* arena, char const* name)
+{
+    constexpr s64 max_callsites_to_log = 16;
+
+    LOG("Arena '%s': capacity %llu, committed %llu, allocated %llu bytes",
+        name, arena->capacity, arena->bytes_committed, arena->bytes_allocated);
+
+    Arena_Stats* stats = arena->stats;
+    if (!stats)
+    {
+        LOG("  No pushes recorded.");
+        return;
+    }
+
+    LOG("  Peak allocated %llu bytes, peak committed %llu bytes, %llu pushes totalling %llu bytes",
+        stats->peak_bytes_allocated, stats->peak_bytes_committed, stats->total_pushes, stats->total_bytes_pushed);
+
+    using Callsite = Hash_Map_Slot<Arena_Callsite_Key, Arena_Callsite_Stats>;
+    s64 num_callsites = stats->callsites.count;
+    Callsite* sorted = (Callsite*)malloc(sizeof(Callsite) * num_callsites);
+    DEFER { free(sorted); };
+
+    s64 idx = 0;
+    for (Callsite const& callsite : stats->callsites)
+    {
+        sorted[idx++] = callsite;
+    }
+    qsort(sorted, num_callsites, sizeof(Callsite), compare_callsites_by_bytes);
+
+    for (s64 i = 0; i < num_callsites && i < max_callsites_to_log; ++i)
+    {
+        LOG("  %10llu bytes in %6llu pushes at %s:%llu",
+            sorted[i].value.bytes_pushed, sorted[i].value.num_pushes, sorted[i].key.file, sorted[i].key.line);
+    }
+}
+#endif // ARENA_TRACKING
+
+Arena arena_allocate(Arena_Params params)
 {
     Arena result = {};
-    result.buffer = malloc(capacity);
-    result.capacity = capacity;
-    result.bytes_allocated = 0;
-    memset(result.buffer, 0, result.bytes_allocated);
+    result.capacity = align_up(params.reserve_size, get_page_size());
+    result.decommit_threshold = align_up(params.decommit_threshold, get_page_size());
+    result.zero_policy = params.zero_policy;
+
+    if (is_set(params.flags, Arena_Flags::EXPLICIT_HUGE_PAGES))
+    {
+        u64 huge_capacity = align_up(result.capacity, C_ARENA_HUGE_PAGE_SIZE);
+        result.buffer = reserve_explicit_huge_pages(huge_capacity);
+        if (result.buffer)
+        {
+            result.capacity = huge_capacity;
+            result.flags = Arena_Flags::EXPLICIT_HUGE_PAGES;
+            result.commit_granularity = C_ARENA_HUGE_PAGE_SIZE;
+            result.decommit_threshold = 0; // Huge page mappings can't be replaced page by page.
+        }
+        else
+        {
+            LOG("Explicit huge pages are unavailable, falling back to regular pages for a %llu byte arena.", result.capacity);
+        }
+    }
+
+    if (!result.buffer && is_set(params.flags, Arena_Flags::TRANSPARENT_HUGE_PAGES))
+    {
+        u64 huge_capacity = align_up(result.capacity, C_ARENA_HUGE_PAGE_SIZE);
+        result.buffer = reserve_pages_huge_aligned(huge_capacity);
+        if (result.buffer && advise_transparent_huge_pages(result.buffer, huge_capacity))
+        {
+            result.capacity = huge_capacity;
+            result.flags = Arena_Flags::TRANSPARENT_HUGE_PAGES;
+            // Commit whole huge pages at a time, otherwise the kernel can only hand us regular pages.
+            result.commit_granularity = C_ARENA_HUGE_PAGE_SIZE;
+            result.decommit_threshold = align_up(result.decommit_threshold, C_ARENA_HUGE_PAGE_SIZE);
+        }
+        else
+        {
+            LOG("Transparent huge pages are unavailable, falling back to regular pages for a %llu byte arena.", result.capacity);
+            if (result.buffer)
+            {
+                release_pages(result.buffer, huge_capacity);
+                result.buffer = nullptr;
+            }
+        }
+    }
+
+    if (!result.buffer)
+    {
+        result.buffer = reserve_pages(result.capacity);
+    }
+
+    ASSERT_MSG(result.buffer != nullptr, "Failed to reserve %llu bytes of address space for arena.", result.capacity);
+    if (!result.buffer)
+    {
+        result.capacity = 0;
+    }
+    result.reserve_size = result.capacity;
     return result;
 }
 
+Arena arena_allocate(u64 capacity)
+{
+    return arena_allocate(Arena_Params{.reserve_size = capacity});
+}
+
 void arena_free(Arena *arena)
 {
     ASSERT(arena->buffer != nullptr);
-    free(arena->buffer);
+    ASSERT_MSG(arena->parent == nullptr, "Child arenas are freed with their parent, use arena_release_child to drop their memory.");
+#if ARENA_TRACKING
+    // The children's Arena structs live inside the range we're about to release, so walk them first.
+    for (Arena* child = arena->first_child; child; child = child->next_sibling)
+    {
+        arena_destroy_stats(child);
+    }
+    arena_destroy_stats(arena);
+#endif
+    release_pages(arena->buffer, arena->reserve_size);
+    arena->buffer = nullptr;
     arena->bytes_allocated = 0;
+    arena->bytes_committed = 0;
     arena->capacity = 0;
+    arena->reserve_size = 0;
+    arena->first_child = nullptr;
 }
 
 Mark arena_mark(Arena *arena)
 {
-    return Mark{arena->bytes_allocated};
+    return Mark{atomic_load_u64(&arena->bytes_allocated)};
 }
 
 void arena_clear_to_mark(Arena *arena, Mark mark)
 {
-    memset((u8 *)arena->buffer + mark.position, 0, arena->bytes_allocated - mark.position);
+    ASSERT(mark.position <= arena->bytes_allocated);
+    if (arena->bytes_allocated > arena->peak_bytes_allocated)
+    {
+        arena->peak_bytes_allocated = arena->bytes_allocated;
+    }
+
+    u64 clear_end = arena->bytes_allocated;
     arena->bytes_allocated = mark.position;
+
+    if (arena->decommit_threshold && (arena->bytes_committed > arena->decommit_threshold))
+    {
+        u64 keep_committed = align_up(arena->bytes_allocated, arena->commit_granularity);
+        if (keep_committed < arena->decommit_threshold)
+        {
+            keep_committed = arena->decommit_threshold;
+        }
+
+        if (keep_committed < arena->bytes_committed)
+        {
+            // Decommitted pages come back zeroed, so there is no need to clear them first.
+            decommit_pages((u8 *)arena->buffer + keep_committed, arena->bytes_committed - keep_committed, arena->flags);
+            arena->bytes_committed = keep_committed;
+            if (clear_end > keep_committed)
+            {
+                clear_end = keep_committed;
+            }
+        }
+    }
+
+    if (clear_end <= mark.position)
+    {
+        return;
+    }
+
+    u8* cleared = (u8 *)arena->buffer + mark.position;
+    switch (arena->zero_policy)
+    {
+    case Arena_Zero_Policy::ZERO_ON_CLEAR:
+        memset(cleared, 0, clear_end - mark.position);
+        break;
+    case Arena_Zero_Policy::DEBUG_POISON:
+        memset(cleared, C_ARENA_POISON_BYTE, clear_end - mark.position);
+        break;
+    case Arena_Zero_Policy::ZERO_ON_PUSH:
+    case Arena_Zero_Policy::NONE:
+        break;
+    }
 }
 
-void* arena_push(Arena *arena, u64 num_bytes)
+static bool arena_commit_to(Arena *arena, u64 num_bytes)
+{
+    if (num_bytes <= arena->bytes_committed)
+    {
+        return true;
+    }
+
+    u64 new_committed = align_up(num_bytes, arena->commit_granularity);
+    if (new_committed > arena->capacity)
+    {
+        new_committed = arena->capacity;
+    }
+
+    if (!commit_pages((u8 *)arena->buffer + arena->bytes_committed, new_committed - arena->bytes_committed))
+    {
+        ASSERT_FAILED_MSG("Failed to commit %llu bytes of arena memory.", new_committed - arena->bytes_committed);
+        return false;
+    }
+
+    atomic_store_u64(&arena->bytes_committed, new_committed);
+    return true;
+}
+
+void* arena_push_no_zero(Arena *arena, u64 num_bytes ARENA_LOC_DEF)
 {
     if ((arena->bytes_allocated + num_bytes) > arena->capacity)
     {
-        ASSERT_FAILED_MSG("Tried to allocate beyond arena capacity.");
+        if (arena->name)
+        {
+            ASSERT_FAILED_MSG("Arena '%s' exceeded its budget of %llu bytes (%llu allocated, %llu requested).",
+                              arena->name, arena->capacity, arena->bytes_allocated, num_bytes);
+        }
+        else
+        {
+            ASSERT_FAILED_MSG("Tried to allocate beyond arena capacity.");
+        }
+        return nullptr;
+    }
+
+    if (!arena_commit_to(arena, arena->bytes_allocated + num_bytes))
+    {
         return nullptr;
     }
 
     void* allocation = (u8 *)arena->buffer + arena->bytes_allocated;
     arena->bytes_allocated += num_bytes;
-    memset(allocation, 0, num_bytes);
+#if ARENA_TRACKING
+    arena_track_push(arena, num_bytes, loc);
+#endif
+    return allocation;
+}
+
+void* arena_push(Arena *arena, u64 num_bytes ARENA_LOC_DEF)
+{
+    void* allocation = arena_push_no_zero(arena, num_bytes ARENA_LOC_ARG);
+    if (!allocation)
+    {
+        return nullptr;
+    }
+
+    switch (arena->zero_policy)
+    {
+    case Arena_Zero_Policy::ZERO_ON_PUSH:
+        memset(allocation, 0, num_bytes);
+        break;
+    case Arena_Zero_Policy::DEBUG_POISON:
+        memset(allocation, C_ARENA_POISON_BYTE, num_bytes);
+        break;
+    case Arena_Zero_Policy::ZERO_ON_CLEAR: // Memory above bytes_allocated is already zero.
+    case Arena_Zero_Policy::NONE:
+        break;
+    }
+
     return allocation;
 }
 
-void* arena_push_a(Arena *arena, u64 num_bytes, u64 alignment)
+static u64 get_align_padding(Arena *arena, u64 alignment)
 {
     u64 mask = alignment - 1;
     ASSERT((alignment > 0) && ((alignment & mask) == 0));
 
     // Check how many bytes extra we need to so we can align the address of arena top
-    u64 misalignment = (uintptr_t(arena->buffer) + arena->bytes_allocated) % alignment;
-    void* allocation = arena_push(arena, num_bytes + misalignment);
+    u64 misalignment = (uintptr_t(arena->buffer) + arena->bytes_allocated) & mask;
+    return misalignment ? (alignment - misalignment) : 0;
+}
+
+void* arena_push_a(Arena *arena, u64 num_bytes, u64 alignment ARENA_LOC_DEF)
+{
+    u64 padding = get_align_padding(arena, alignment);
+    void* allocation = arena_push(arena, num_bytes + padding ARENA_LOC_ARG);
+    if (!allocation)
+    {
+        return nullptr;
+    }
 
     // Align the allocated pointer
-    return (char*)allocation + misalignment;
-}
\ No newline at end of file
+    return (char*)allocation + padding;
+}
+
+void* arena_push_no_zero_a(Arena *arena, u64 num_bytes, u64 alignment ARENA_LOC_DEF)
+{
+    u64 padding = get_align_padding(arena, alignment);
+    void* allocation = arena_push_no_zero(arena, num_bytes + padding ARENA_LOC_ARG);
+    if (!allocation)
+    {
+        return nullptr;
+    }
+
+    return (char*)allocation + padding;
+}
+
+Arena* arena_create_child(Arena* parent, Arena_Child_Params params)
+{
+    ASSERT_MSG(params.budget > 0, "Child arena '%s' needs a budget.", params.name ? params.name : "");
+
+    // Keep the child's range aligned so that it can be committed independently from the parent.
+    u64 budget = align_up(params.budget, parent->commit_granularity);
+
+    // The child's Arena comes out of the parent, so the room check has to include it and the
+    // pages pushing it may have committed. Otherwise the child's range would start below them.
+    Mark mark = arena_mark(parent);
+    Arena* child = arena_push_t<Arena>(parent);
+    if (!child)
+    {
+        return nullptr;
+    }
+
+    if ((budget > parent->capacity) ||
+        (parent->capacity - budget < parent->bytes_allocated) ||
+        (parent->capacity - budget < parent->bytes_committed))
+    {
+        arena_clear_to_mark(parent, mark);
+        ASSERT_FAILED_MSG("Not enough room left in the parent arena to carve out %llu bytes for child arena '%s'.",
+                          budget, params.name ? params.name : "");
+        return nullptr;
+    }
+
+    parent->capacity -= budget;
+
+    // The push only zeroes under ZERO_ON_PUSH, every field not set below has to start out default.
+    *child = Arena{};
+    child->buffer = (u8 *)parent->buffer + parent->capacity;
+    child->capacity = budget;
+    child->decommit_threshold = align_up(params.decommit_threshold, parent->commit_granularity);
+    child->zero_policy = parent->zero_policy;
+    child->flags = parent->flags;
+    child->commit_granularity = parent->commit_granularity;
+    child->name = params.name;
+    child->parent = parent;
+    child->next_sibling = parent->first_child;
+    parent->first_child = child;
+
+    return child;
+}
+
+void arena_release_child(Arena* child)
+{
+    ASSERT_MSG(child->parent != nullptr, "arena_release_child called on an arena without a parent.");
+
+    if (is_set(child->flags, Arena_Flags::EXPLICIT_HUGE_PAGES))
+    {
+        // Can't decommit these, just reset.
+        arena_clear_to_mark(child, Mark{0});
+        return;
+    }
+
+    if (child->bytes_allocated > child->peak_bytes_allocated)
+    {
+        child->peak_bytes_allocated = child->bytes_allocated;
+    }
+
+    if (child->bytes_committed)
+    {
+        decommit_pages(child->buffer, child->bytes_committed, child->flags);
+    }
+    child->bytes_allocated = 0;
+    child->bytes_committed = 0;
+}
+
+Arena_Snapshot arena_snapshot_create(Arena* arena)
+{
+    ASSERT_MSG(arena->first_child == nullptr, "Arenas with children can't be snapshot as a whole, snapshot the children instead.");
+
+    Arena_Snapshot snapshot;
+    snapshot.arena = arena;
+    snapshot.bytes_allocated = arena->bytes_allocated;
+    snapshot.bytes_committed = arena->bytes_committed;
+    snapshot.peak_bytes_allocated = arena->peak_bytes_allocated;
+    snapshot.data_size = align_up(arena->bytes_allocated, get_page_size());
+    if (!snapshot.data_size)
+    {
+        return snapshot;
+    }
+
+    snapshot.data = reserve_pages(snapshot.data_size);
+    if (!snapshot.data || !commit_pages(snapshot.data, snapshot.data_size))
+    {
+        ASSERT_FAILED_MSG("Failed to allocate %llu bytes for arena snapshot.", snapshot.data_size);
+        if (snapshot.data)
+        {
+            release_pages(snapshot.data, snapshot.data_size);
+        }
+        return {};
+    }
+
+#if ARENA_SNAPSHOT_VM_COPY
+    // vm_copy shares the pages copy-on-write instead of copying them right away.
+    if (vm_copy(mach_task_self(), vm_address_t(arena->buffer), vm_size_t(snapshot.data_size), vm_address_t(snapshot.data)) != KERN_SUCCESS)
+    {
+        memcpy(snapshot.data, arena->buffer, snapshot.data_size);
+    }
+#else
+    memcpy(snapshot.data, arena->buffer, snapshot.data_size);
+#endif
+    return snapshot;
+}
+
+bool arena_snapshot_restore(Arena_Snapshot* snapshot)
+{
+    ASSERT(snapshot->is_valid());
+    Arena* arena = snapshot->arena;
+
+    // A child carved out since the snapshot lowered the capacity and lives below it, resetting
+    // bytes_allocated would hand its range out again.
+    if (arena->first_child)
+    {
+        ASSERT_FAILED_MSG("Arena '%s' got children after its snapshot was taken, it can't be restored.", arena->name ? arena->name : "");
+        return false;
+    }
+
+    if (snapshot->data_size && !arena_commit_to(arena, snapshot->data_size))
+    {
+        return false;
+    }
+
+    if (snapshot->data_size)
+    {
+
+#if ARENA_SNAPSHOT_VM_COPY
+        if (vm_copy(mach_task_self(), vm_address_t(snapshot->data), vm_size_t(snapshot->data_size), vm_address_t(arena->buffer)) != KERN_SUCCESS)
+        {
+            memcpy(arena->buffer, snapshot->data, snapshot->data_size);
+        }
+#else
+        memcpy(arena->buffer, snapshot->data, snapshot->data_size);
+#endif
+    }
+
+    // Whatever got committed past the snapshot has to read as zero again.
+    if (arena->bytes_committed > snapshot->data_size)
+    {
+        u8* above = (u8 *)arena->buffer + snapshot->data_size;
+        u64 num_above = arena->bytes_committed - snapshot->data_size;
+        if (is_set(arena->flags, Arena_Flags::EXPLICIT_HUGE_PAGES))
+        {
+            memset(above, 0, num_above);
+        }
+        else
+        {
+            decommit_pages(above, num_above, arena->flags);
+            arena->bytes_committed = snapshot->data_size;
+        }
+    }
+
+    arena->bytes_allocated = snapshot->bytes_allocated;
+    arena->peak_bytes_allocated = snapshot->peak_bytes_allocated;
+    return true;
+}
+
+void arena_snapshot_destroy(Arena_Snapshot* snapshot)
+{
+    if (snapshot->data)
+    {
+        release_pages(snapshot->data, snapshot->data_size);
+    }
+    *snapshot = {};
+}
+
+Arena_Budget_Info arena_get_budget_info(Arena* arena)
+{
+    Arena_Budget_Info info;
+    info.name = arena->name;
+    info.budget = arena->capacity;
+    info.bytes_allocated = arena->bytes_allocated;
+    info.bytes_committed = arena->bytes_committed;
+    info.peak_bytes_allocated = (arena->bytes_allocated > arena->peak_bytes_allocated) ? arena->bytes_allocated : arena->peak_bytes_allocated;
+    return info;
+}
+
+Array<Arena_Budget_Info> arena_get_budget_table(Arena* parent, Arena* out_arena)
+{
+    s64 num_children = 0;
+    for (Arena* child = parent->first_child; child; child = child->next_sibling)
+    {
+        ++num_children;
+    }
+
+    Array<Arena_Budget_Info> table = arena_push_array<Arena_Budget_Info>(out_arena, num_children);
+    for (Arena* child = parent->first_child; child; child = child->next_sibling)
+    {
+        array_push(&table, arena_get_budget_info(child));
+    }
+    return table;
+}
+
+void arena_budget_dump(Arena* parent)
+{
+    LOG("[Arena] Budgets of %s:", parent->name ? parent->name : "arena");
+    for (Arena* child = parent->first_child; child; child = child->next_sibling)
+    {
+        Arena_Budget_Info info = arena_get_budget_info(child);
+        LOG("[Arena]   %-12s %10llu / %10llu bytes (peak %llu, committed %llu)",
+            info.name ? info.name : "?", info.bytes_allocated, info.budget, info.peak_bytes_allocated, info.bytes_committed);
+    }
+}
+
+void* arena_push_atomic(Arena* arena, u64 num_bytes, u64 alignment)
+{
+    ASSERT_MSG(is_pow2(alignment), "Alignment (%llu) must be a power of two.", alignment);
+
+    // Claim enough to align the start wherever the range ends up. A claim that doesn't fit is
+    // never published, so a failed push leaves bytes_allocated where it was.
+    u64 claim = num_bytes + alignment - 1;
+    u64 start = atomic_load_u64(&arena->bytes_allocated);
+    u64 end = 0;
+    do
+    {
+        end = start + claim;
+        if (end < start || end > arena->capacity)
+        {
+            ASSERT_FAILED_MSG("Exceeded arena capacity of %llu bytes with an atomic push of %llu bytes.", arena->capacity, num_bytes);
+            return nullptr;
+        }
+    } while (!atomic_compare_exchange_u64(&arena->bytes_allocated, &start, end));
+
+    if (end > atomic_load_u64(&arena->bytes_committed))
+    {
+        while (atomic_exchange_u32(&arena->commit_lock, 1))
+        {
+            cpu_relax();
+        }
+
+        // Another thread may have committed past our range while we were waiting.
+        bool committed = arena_commit_to(arena, end);
+        atomic_store_u32(&arena->commit_lock, 0);
+
+        if (!committed)
+        {
+            return nullptr;
+        }
+    }
+
+    u8* result = (u8*)align_up(uintptr_t(arena->buffer) + start, alignment);
+    switch (arena->zero_policy)
+    {
+    case Arena_Zero_Policy::ZERO_ON_PUSH:
+        memset(result, 0, num_bytes);
+        break;
+    case Arena_Zero_Policy::DEBUG_POISON:
+        memset(result, C_ARENA_POISON_BYTE, num_bytes);
+        break;
+    case Arena_Zero_Policy::ZERO_ON_CLEAR:
+    case Arena_Zero_Policy::NONE:
+        break;
+    }
+
+    return result;
+}
+
+Arena_Thread_Block arena_thread_block_create(Arena* arena, u64 block_size)
+{
+    Arena_Thread_Block block;
+    block.arena = arena;
+    block.block_size = block_size;
+    return block;
+}
+
+void* arena_thread_block_push(Arena_Thread_Block* block, u64 num_bytes, u64 alignment)
+{
+    ASSERT_MSG(is_pow2(alignment), "Alignment (%llu) must be a power of two.", alignment);
+
+    u8* result = (u8*)align_up(uintptr_t(block->cursor), alignment);
+    if (!block->cursor || result + num_bytes > block->end)
+    {
+        // Oversized requests get their own range instead of throwing away most of a block.
+        if (num_bytes > block->block_size / 4)
+        {
+            return arena_push_atomic(block->arena, num_bytes, alignment);
+        }
+
+        block->cursor = (u8*)arena_push_atomic(block->arena, block->block_size, alignment);
+        if (!block->cursor)
+        {
+            block->end = nullptr;
+            return nullptr;
+        }
+        block->end = block->cursor + block->block_size;
+        result = block->cursor;
+    }
+
+    block->cursor = result + num_bytes;
+    return result;
+}
+
+Frame_Arenas frame_arenas_create(s64 frames_in_flight, Arena_Params params)
+{
+    ASSERT_MSG(frames_in_flight > 0 && frames_in_flight <= C_MAX_FRAME_ARENAS,
+               "Unsupported number of frames in flight: %lld", frames_in_flight);
+
+    Frame_Arenas result = {};
+    result.frames_in_flight = frames_in_flight;
+    for (s64 i = 0; i < frames_in_flight; ++i)
+    {
+        result.arenas[i] = arena_allocate(params);
+    }
+    return result;
+}
+
+void frame_arenas_destroy(Frame_Arenas* frame_arenas)
+{
+    for (s64 i = 0; i < frame_arenas->frames_in_flight; ++i)
+    {
+        arena_free(&frame_arenas->arenas[i]);
+    }
+    frame_arenas->frames_in_flight = 0;
+}
+
+Arena* frame_arenas_begin(Frame_Arenas* frame_arenas, s64 frame_idx)
+{
+    ASSERT(frame_idx >= 0 && frame_idx < frame_arenas->frames_in_flight);
+    Arena* arena = &frame_arenas->arenas[frame_idx];
+    arena_clear_to_mark(arena, Mark{0});
+    return arena;
+}
+
+struct Scratch_Arenas
+{
+    Arena arenas[C_SCRATCH_ARENA_COUNT];
+
+    ~Scratch_Arenas()
+    {
+        for (Arena& arena : arenas)
+        {
+            if (arena.buffer)
+            {
+                arena_free(&arena);
+            }
+        }
+    }
+};
+
+static thread_local Scratch_Arenas tls_scratch;
+
+Scratch scratch_begin(Slice<Arena*> conflicts)
+{
+    for (Arena& candidate : tls_scratch.arenas)
+    {
+        bool is_conflict = false;
+        for (Arena* conflict : conflicts)
+        {
+            if (conflict == &candidate)
+            {
+                is_conflict = true;
+                break;
+            }
+        }
+
+        if (is_conflict)
+        {
+            continue;
+        }
+
+        if (!candidate.buffer)
+        {
+            candidate = arena_allocate(Arena_Params{
+                .reserve_size = C_SCRATCH_ARENA_RESERVE_SIZE,
+                .decommit_threshold = 1024 * 1024,
+            });
+        }
+
+        return Scratch{&candidate, arena_mark(&candidate)};
+    }
+
+    ASSERT_FAILED_MSG("All %lld scratch arenas of this thread conflict with the arenas passed in.", C_SCRATCH_ARENA_COUNT);
+    return Scratch{};
+}
+
+Scratch scratch_begin(Arena* conflict)
+{
+    Arena* conflicts[] = {conflict};
+    return scratch_begin(Slice<Arena*>(conflicts));
+}
+
+Scratch scratch_begin()
+{
+    return scratch_begin(Slice<Arena*>());
+}
+
+void scratch_end(Scratch scratch)
+{
+    arena_clear_to_mark(scratch.arena, scratch.mark);
+}
@@ -1,13 +1,106 @@
 #pragma once
 #include "core.h"
 
+// Arena tracking records high-water marks, allocation counts and bytes per callsite.
+// It defaults to on in debug builds and compiles out completely otherwise.
+#ifndef ARENA_TRACKING
+#define ARENA_TRACKING DEBUG_BUILD
+#endif
+
+#if ARENA_TRACKING
+// Appended to the parameter list of every push function, so the callsite gets captured
+// without having to touch the callers. Use _DECL on declarations, _DEF on the definition.
+#define ARENA_LOC_DECL , Source_Location loc = SOURCE_LOCATION_CURRENT
+#define ARENA_LOC_DEF , Source_Location loc
+#define ARENA_LOC_ARG , loc
+#else
+#define ARENA_LOC_DECL
+#define ARENA_LOC_DEF
+#define ARENA_LOC_ARG
+#endif
+
+struct Arena_Stats;
+
+// Arenas reserve a range of virtual address space up front and only commit
+// physical pages once bytes_allocated grows into them. Reserving is cheap, so
+// arenas can be given far more room than they are expected to need.
+constexpr u64 C_ARENA_DEFAULT_RESERVE_SIZE = 64ull * 1024 * 1024 * 1024;
+
+// Pages are committed in blocks of this size to avoid calling into the OS on every push.
+constexpr u64 C_ARENA_COMMIT_GRANULARITY = 64 * 1024;
+
+// Controls when an arena writes to its memory on behalf of the caller.
+enum class Arena_Zero_Policy : u8
+{
+    ZERO_ON_PUSH,  // Every push is memset to zero. Safe default for code that expects zero-initialized structs.
+    ZERO_ON_CLEAR, // Freed ranges are zeroed on clear, so pushes can hand out memory that is already zero.
+    NONE,          // Memory is never touched, pushed bytes may contain data from earlier allocations.
+    DEBUG_POISON,  // Pushed and freed memory is filled with C_ARENA_POISON_BYTE to catch reads of uninitialized data.
+};
+
+constexpr u8 C_ARENA_POISON_BYTE = 0xCD;
+
+// Large arenas that get accessed randomly (mesh and texture staging data) can ask to be backed
+// by huge pages to cut down on TLB misses. Both requests fall back to regular pages
+// when the OS can't provide them, check Arena::flags to see what the arena actually got.
+enum class Arena_Flags : u8
+{
+    NONE = 0,
+    TRANSPARENT_HUGE_PAGES = 0x1, // Hint the kernel to back the range with huge pages where it can (madvise(MADV_HUGEPAGE)).
+    EXPLICIT_HUGE_PAGES = 0x2,    // Map the range from the explicit huge page pool (MAP_HUGETLB), the whole reserve is taken from the pool up front. Such arenas never decommit.
+};
+
+static inline Arena_Flags operator|(Arena_Flags lhs, Arena_Flags rhs)
+{
+    return Arena_Flags(u8(lhs) | u8(rhs));
+}
+
+static inline bool is_set(Arena_Flags flags, Arena_Flags val)
+{
+    return u8(flags) & u8(val);
+}
+
+constexpr u64 C_ARENA_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
 struct Arena
 {
     void* buffer = nullptr;
-    u64 capacity = 0;
+    u64 capacity = 0;        // How far the arena may grow. Carving out a child lowers the parent's capacity by the child's budget.
+    u64 reserve_size = 0;    // Size of the reserved address range the arena owns, zero for children.
     u64 bytes_allocated = 0;
+    u64 bytes_committed = 0;
+    u64 peak_bytes_allocated = 0; // Updated when clearing, see arena_get_budget_info.
+
+    // When clearing, committed memory above this size is given back to the OS.
+    // Zero keeps everything committed until the arena is freed.
+    u64 decommit_threshold = 0;
+
+    Arena_Zero_Policy zero_policy = Arena_Zero_Policy::ZERO_ON_PUSH;
+    Arena_Flags flags = Arena_Flags::NONE;
+    u64 commit_granularity = C_ARENA_COMMIT_GRANULARITY;
+
+    // Serializes committing more memory between threads using arena_push_atomic.
+    u32 commit_lock = 0;
+
+    char const* name = nullptr;
+    Arena* parent = nullptr;
+    Arena* first_child = nullptr;
+    Arena* next_sibling = nullptr;
+
+#if ARENA_TRACKING
+    Arena_Stats* stats = nullptr; // Created on the first push.
+#endif
+};
+
+struct Arena_Params
+{
+    u64 reserve_size = C_ARENA_DEFAULT_RESERVE_SIZE;
+    u64 decommit_threshold = 0;
+    Arena_Zero_Policy zero_policy = Arena_Zero_Policy::ZERO_ON_PUSH;
+    Arena_Flags flags = Arena_Flags::NONE;
 };
 
+Arena arena_allocate(Arena_Params params);
 Arena arena_allocate(u64 capacity);
 void arena_free(Arena* arena);
 
@@ -19,15 +112,72 @@ struct Mark // TODO(): Should this be called MemoryMark?
 Mark arena_mark(Arena* arena);
 void arena_clear_to_mark(Arena* arena, Mark mark);
 
-void* arena_push(Arena* arena, u64 num_bytes);
-void* arena_push_a(Arena* arena, u64 num_bytes, u64 alignment);
+void* arena_push(Arena* arena, u64 num_bytes ARENA_LOC_DECL);
+void* arena_push_a(Arena* arena, u64 num_bytes, u64 alignment ARENA_LOC_DECL);
+
+// Same as arena_push, but never zeroes the returned memory regardless of the arena's zero policy.
+// Use this when the caller overwrites the whole allocation anyway (e.g. reading a file into it).
+void* arena_push_no_zero(Arena* arena, u64 num_bytes ARENA_LOC_DECL);
+void* arena_push_no_zero_a(Arena* arena, u64 num_bytes, u64 alignment ARENA_LOC_DECL);
+
+template <typename T>
+T* arena_push_t(Arena* arena ARENA_LOC_DECL)
+{
+    return (T*)arena_push_a(arena, sizeof(T), alignof(T) ARENA_LOC_ARG);
+}
+
+// Several threads can fill one shared arena (e.g. a frame's draw list built by parallel
+// culling jobs) through arena_push_atomic, which claims its range with a compare-exchange on
+// bytes_allocated. Atomic and regular pushes must not overlap in time, and neither may
+// arena_clear_to_mark: take the Mark before starting the jobs and clear after joining them.
+// Atomic pushes are not recorded by ARENA_TRACKING.
+//
+// To keep threads from hammering the shared counter, each job can carve its allocations
+// out of an Arena_Thread_Block, which only touches the arena once per block. Blocks point
+// into the arena, so they must not outlive a clear back past where they were refilled.
+constexpr u64 C_ARENA_THREAD_BLOCK_SIZE = 64 * 1024;
+
+void* arena_push_atomic(Arena* arena, u64 num_bytes, u64 alignment);
+
+struct Arena_Thread_Block
+{
+    Arena* arena = nullptr;
+    u8* cursor = nullptr;
+    u8* end = nullptr;
+    u64 block_size = 0;
+};
+
+Arena_Thread_Block arena_thread_block_create(Arena* arena, u64 block_size = C_ARENA_THREAD_BLOCK_SIZE);
+
+// Not thread safe itself, each thread owns its own block.
+void* arena_thread_block_push(Arena_Thread_Block* block, u64 num_bytes, u64 alignment);
 
 template <typename T>
-T* arena_push_t(Arena* arena)
+T* arena_thread_block_push_t(Arena_Thread_Block* block)
 {
-    return (T*)arena_push_a(arena, sizeof(T), alignof(T));
+    return (T*)arena_thread_block_push(block, sizeof(T), alignof(T));
 }
 
+#if ARENA_TRACKING
+struct Arena_Frame_Summary
+{
+    u64 bytes_pushed = 0;
+    u64 num_pushes = 0;
+    u64 peak_bytes_allocated = 0;
+    bool is_new_high_water_mark = false;
+};
+
+// Closes the current frame of the arena's statistics and returns what happened during it.
+Arena_Frame_Summary arena_stats_end_frame(Arena* arena);
+
+// Logs the arena's high-water marks and the callsites that pushed the most bytes.
+void arena_stats_dump(Arena* arena, char const* name);
+#else
+struct Arena_Frame_Summary {};
+static inline Arena_Frame_Summary arena_stats_end_frame(Arena*) { return {}; }
+static inline void arena_stats_dump(Arena*, char const*) {}
+#endif
+
 template <typename T>
 struct Array
 {
@@ -37,7 +187,13 @@ struct Array
 
     T& operator[](s64 idx)
     {
-        ASSERT(idx < size);
+        ASSERT_DEBUG(idx >= 0 && idx < size);
+        return array[idx];
+    }
+
+    // No bounds check at any assert level, for inner loops whose range is already known to be valid.
+    T& get_unchecked(s64 idx)
+    {
         return array[idx];
     }
 
@@ -76,7 +232,12 @@ struct Slice
 
     T const& operator[](s64 idx) const
     {
-        ASSERT(idx < count);
+        ASSERT_DEBUG(idx >= 0 && idx < count);
+        return array[idx];
+    }
+
+    T const& get_unchecked(s64 idx) const
+    {
         return array[idx];
     }
 
@@ -148,20 +309,125 @@ bool try_array_push(Array<T>* arr, T const& v)
 }
 
 template <typename T>
-Array<T> arena_push_array(Arena* arena, s64 size)
+Array<T> arena_push_array(Arena* arena, s64 size ARENA_LOC_DECL)
+{
+    void* allocation = arena_push_a(arena, sizeof(T) * size, alignof(T) ARENA_LOC_ARG);
+    return Array<T>{(T*)allocation, size, 0};
+}
+
+template <typename T>
+Array<T> arena_push_array_no_zero(Arena* arena, s64 size ARENA_LOC_DECL)
 {
-    void* allocation = arena_push_a(arena, sizeof(T) * size, alignof(T));
+    void* allocation = arena_push_no_zero_a(arena, sizeof(T) * size, alignof(T) ARENA_LOC_ARG);
     return Array<T>{(T*)allocation, size, 0};
 }
 
 template <typename T>
-Array<T> arena_push_array_with_count(Arena* arena, s64 size, s64 count)
+Array<T> arena_push_array_with_count(Arena* arena, s64 size, s64 count ARENA_LOC_DECL)
 {
-    void* allocation = arena_push_a(arena, sizeof(T) * size, alignof(T));
+    void* allocation = arena_push_a(arena, sizeof(T) * size, alignof(T) ARENA_LOC_ARG);
     return Array<T>{(T*)allocation, size, count};
 }
 
+// A child arena is carved out of the top of its parent's reserved range, its budget is
+// the child's capacity and is enforced the same way. This lets us cap the permanent memory
+// of each subsystem (renderer, assets, ...) and drop all of it at once with
+// arena_release_child, which resets the child and hands its pages back to the OS in a
+// single call, no matter how many allocations it held. The child stays usable afterwards.
+//
+// Children live as long as their parent and are freed with it. The Arena itself is
+// allocated from the parent, so pointers to it stay valid.
+struct Arena_Child_Params
+{
+    char const* name = nullptr;
+    u64 budget = 0;
+    u64 decommit_threshold = 0;
+};
+
+Arena* arena_create_child(Arena* parent, Arena_Child_Params params);
+void arena_release_child(Arena* child);
+
+struct Arena_Budget_Info
+{
+    char const* name = nullptr;
+    u64 budget = 0;
+    u64 bytes_allocated = 0;
+    u64 bytes_committed = 0;
+    u64 peak_bytes_allocated = 0;
+};
+
+Arena_Budget_Info arena_get_budget_info(Arena* arena);
+
+// Returns one row per child of parent, allocated from out_arena.
+Array<Arena_Budget_Info> arena_get_budget_table(Arena* parent, Arena* out_arena);
+void arena_budget_dump(Arena* parent);
+
+// Captures the full contents of an arena so it can later be put back exactly as it was,
+// e.g. to throw away an editor play mode session and return to the state before it.
+// On macOS the pages are captured and put back with vm_copy, which shares them copy-on-write
+// where it can instead of copying the whole arena, everywhere else they are memcpy'd.
+// Everything pushed after the snapshot is dropped by a restore. Children are not included
+// in their parent's snapshot, snapshot them individually.
+// A restore fails and leaves the arena as it is if the arena got children since the snapshot
+// or its pages can't be committed again.
+struct Arena_Snapshot
+{
+    Arena* arena = nullptr;
+    u64 bytes_allocated = 0;
+    u64 bytes_committed = 0;
+    u64 peak_bytes_allocated = 0;
+
+    void* data = nullptr; // Copy of the arena's pages.
+    u64 data_size = 0;
+
+    bool is_valid() const { return arena != nullptr; }
+    operator bool() const { return is_valid(); }
+};
+
+Arena_Snapshot arena_snapshot_create(Arena* arena);
+bool arena_snapshot_restore(Arena_Snapshot* snapshot);
+void arena_snapshot_destroy(Arena_Snapshot* snapshot);
+
 #define ARENA_DEFER_CLEAR(arena)                      \
     Mark CONCAT(mark_, __LINE__) = arena_mark(arena); \
-    DEFER { arena_clear_to_mark(arena, CONCAT(mark_, __LINE__)); };\
-    
\ No newline at end of file
+    DEFER { arena_clear_to_mark(arena, CONCAT(mark_, __LINE__)); };
+
+// One arena per frame in flight. Memory pushed during a frame stays valid until the
+// same frame slot comes around again, which is exactly as long as the GPU may still
+// read from it through that frame's command buffers. frame_arenas_begin must only be
+// called once the frame slot's fence has been waited on.
+constexpr s64 C_MAX_FRAME_ARENAS = 4;
+
+struct Frame_Arenas
+{
+    Arena arenas[C_MAX_FRAME_ARENAS];
+    s64 frames_in_flight = 0;
+};
+
+Frame_Arenas frame_arenas_create(s64 frames_in_flight, Arena_Params params);
+void frame_arenas_destroy(Frame_Arenas* frame_arenas);
+
+// Resets and returns the arena for frame_idx.
+Arena* frame_arenas_begin(Frame_Arenas* frame_arenas, s64 frame_idx);
+
+// Every thread owns a small pool of scratch arenas for temporary allocations, so code
+// can allocate temporaries without locking and without having a Context passed in.
+// scratch_begin hands out an arena that is not one of the given conflicts, which lets a
+// function use scratch memory while also pushing results into an arena its caller passed
+// in (which may itself be the caller's scratch arena).
+constexpr s64 C_SCRATCH_ARENA_COUNT = 2;
+constexpr u64 C_SCRATCH_ARENA_RESERVE_SIZE = 8ull * 1024 * 1024 * 1024;
+
+struct Scratch
+{
+    Arena* arena = nullptr;
+    Mark mark;
+};
+
+Scratch scratch_begin();
+Scratch scratch_begin(Arena* conflict);
+Scratch scratch_begin(Slice<Arena*> conflicts);
+void scratch_end(Scratch scratch);
+
+#define SCRATCH_DEFER_END(scratch) \
+    DEFER { scratch_end(scratch); };
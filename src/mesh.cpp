@@ -0,0 +1,79 @@
+#include "mesh.h"
+
+Mat4 mesh_dequantize_matrix(AABB const& bounds)
+{
+    Vec3 center = aabb_center(bounds);
+    Vec3 half_extent = aabb_half_extent(bounds);
+    return Mat4(
+        half_extent.x, 0.f,           0.f,           center.x,
+        0.f,           half_extent.y, 0.f,           center.y,
+        0.f,           0.f,           half_extent.z, center.z,
+        0.f,           0.f,           0.f,           1.f);
+}
+
+Array<Packed_Position> mesh_pack_positions(Arena* arena, Slice<Vec3> positions, AABB const& bounds)
+{
+    Vec3 center = aabb_center(bounds);
+    Vec3 half_extent = aabb_half_extent(bounds);
+
+    // A flat axis packs to 0, which the dequantize matrix maps back onto the center.
+    Vec3 inv_half_extent{
+        half_extent.x > 0.0f ? 1.0f / half_extent.x : 0.0f,
+        half_extent.y > 0.0f ? 1.0f / half_extent.y : 0.0f,
+        half_extent.z > 0.0f ? 1.0f / half_extent.z : 0.0f,
+    };
+
+    Array<Packed_Position> packed = arena_push_array_with_count<Packed_Position>(arena, positions.count, positions.count);
+    for (s64 i = 0; i < positions.count; ++i)
+    {
+        Vec3 local = (positions.get_unchecked(i) - center) * inv_half_extent;
+        packed.get_unchecked(i) = Packed_Position{ pack_snorm16(local.x), pack_snorm16(local.y), pack_snorm16(local.z), 0 };
+    }
+    return packed;
+}
+
+Array<Packed_Color> mesh_pack_colors(Arena* arena, Slice<Vec3> colors)
+{
+    Array<Packed_Color> packed = arena_push_array_with_count<Packed_Color>(arena, colors.count, colors.count);
+    for (s64 i = 0; i < colors.count; ++i)
+    {
+        Vec3 c = colors.get_unchecked(i);
+        packed.get_unchecked(i) = Packed_Color{ pack_unorm8(c.x), pack_unorm8(c.y), pack_unorm8(c.z), 255 };
+    }
+    return packed;
+}
+
+Array<Packed_Normal> mesh_pack_normals(Arena* arena, Slice<Vec3> normals)
+{
+    Array<Packed_Normal> packed = arena_push_array_with_count<Packed_Normal>(arena, normals.count, normals.count);
+    for (s64 i = 0; i < normals.count; ++i)
+    {
+        packed.get_unchecked(i) = pack_normal(normals.get_unchecked(i));
+    }
+    return packed;
+}
+
+// Round trip checks for the packing, evaluated at compile time like the ones in mathlib.h.
+static constexpr bool test_vertex_packing()
+{
+    ASSERT(unpack_snorm16(pack_snorm16(1.0f)) == 1.0f);
+    ASSERT(unpack_snorm16(pack_snorm16(-1.0f)) == -1.0f);
+    ASSERT(pack_snorm16(0.0f) == 0);
+    ASSERT(unpack_unorm8(pack_unorm8(1.0f)) == 1.0f);
+    ASSERT(pack_unorm8(0.5f) == 128);
+
+    // Corners, axes and both hemispheres, including the folded seams of the octahedron.
+    Vec3 const normals[] = {
+        Vec3{ 0.f, 0.f, 1.f }, Vec3{ 0.f, 0.f, -1.f }, Vec3{ 1.f, 0.f, 0.f }, Vec3{ 0.f, -1.f, 0.f },
+        Vec3{ 1.f, 1.f, 1.f }, Vec3{ -1.f, 1.f, -1.f }, Vec3{ 0.3f, -0.8f, -0.1f }, Vec3{ -0.05f, 0.02f, -1.f },
+    };
+    for (Vec3 n : normals)
+    {
+        Vec3 unit = normalized(n);
+        Vec3 decoded = unpack_normal(pack_normal(unit));
+        ASSERT(math_abs(decoded.x - unit.x) <= 1e-4f && math_abs(decoded.y - unit.y) <= 1e-4f && math_abs(decoded.z - unit.z) <= 1e-4f);
+    }
+    return true;
+}
+
+static_assert(test_vertex_packing());
@@ -0,0 +1,111 @@
+#pragma once
+#include "core.h"
+#include "mathlib.h"
+#include "memory.h"
+
+// Vertex streams are stored quantized, in the formats the GPU uploads and fetches them in:
+// - positions as snorm16 relative to the mesh bounds,
+// - colors as RGBA8,
+// - normals as snorm16 octahedral coordinates.
+// A position + color vertex goes from 24 to 12 bytes, 36 to 16 with normals.
+//
+// Vertex fetch converts the normalized integers back to floats on its own. Positions then
+// still need to be mapped from [-1, 1] back to the bounds, mesh_dequantize_matrix does that
+// and is meant to be multiplied into the model matrix, so the shader doesn't pay for it.
+// Normals need the octahedral decode in the shader, see oct_decode in basic.vert.glsl.
+
+// VK_FORMAT_R16G16B16A16_SNORM. Three component 16 bit formats aren't guaranteed to be
+// supported for vertex buffers, w is padding.
+struct Packed_Position
+{
+    s16 x = 0;
+    s16 y = 0;
+    s16 z = 0;
+    s16 w = 0;
+};
+
+// VK_FORMAT_R8G8B8A8_UNORM
+struct Packed_Color
+{
+    u8 r = 0;
+    u8 g = 0;
+    u8 b = 0;
+    u8 a = 255;
+};
+
+// VK_FORMAT_R16G16_SNORM
+struct Packed_Normal
+{
+    s16 x = 0;
+    s16 y = 0;
+};
+
+// Same conversions as the Vulkan spec uses when fetching, rounding to nearest.
+static constexpr s16 pack_snorm16(f32 v)
+{
+    v = clamp(v, -1.0f, 1.0f) * 32767.0f;
+    return s16(v >= 0.0f ? v + 0.5f : v - 0.5f);
+}
+
+static constexpr f32 unpack_snorm16(s16 v)
+{
+    return math_max(f32(v) / 32767.0f, -1.0f);
+}
+
+static constexpr u8 pack_unorm8(f32 v)
+{
+    return u8(clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+static constexpr f32 unpack_unorm8(u8 v)
+{
+    return f32(v) / 255.0f;
+}
+
+// Projects a unit vector onto the octahedron |x| + |y| + |z| = 1 and unfolds the lower half
+// over the diagonals, which gives a square in [-1, 1]. Error is at most ~6e-5 with 16 bits.
+static constexpr Vec2 oct_encode(Vec3 n)
+{
+    f32 inv_l1 = 1.0f / (math_abs(n.x) + math_abs(n.y) + math_abs(n.z));
+    Vec2 p{ n.x * inv_l1, n.y * inv_l1 };
+    if (n.z < 0.0f)
+    {
+        p = Vec2{
+            (1.0f - math_abs(p.y)) * (p.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - math_abs(p.x)) * (p.y >= 0.0f ? 1.0f : -1.0f)
+        };
+    }
+    return p;
+}
+
+static constexpr Vec3 oct_decode(Vec2 e)
+{
+    Vec3 n{ e.x, e.y, 1.0f - math_abs(e.x) - math_abs(e.y) };
+    if (n.z < 0.0f)
+    {
+        n.x = (1.0f - math_abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f);
+        n.y = (1.0f - math_abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return normalized(n);
+}
+
+static constexpr Packed_Normal pack_normal(Vec3 n)
+{
+    Vec2 e = oct_encode(n);
+    return Packed_Normal{ pack_snorm16(e.x), pack_snorm16(e.y) };
+}
+
+static constexpr Vec3 unpack_normal(Packed_Normal n)
+{
+    return oct_decode(Vec2{ unpack_snorm16(n.x), unpack_snorm16(n.y) });
+}
+
+// Maps packed positions from [-1, 1] back into the bounds they were packed relative to,
+// usually aabb_from_points(positions).
+// Model space position = mesh_dequantize_matrix(bounds) * (unpacked.xyz, 1).
+Mat4 mesh_dequantize_matrix(AABB const& bounds);
+
+// Max error per axis is about half_extent / 65534.
+Array<Packed_Position> mesh_pack_positions(Arena* arena, Slice<Vec3> positions, AABB const& bounds);
+Array<Packed_Color> mesh_pack_colors(Arena* arena, Slice<Vec3> colors);
+Array<Packed_Normal> mesh_pack_normals(Arena* arena, Slice<Vec3> normals);
@@ -52,4 +52,16 @@ bool is_file_valid(File_Handle handle);
 File_Handle open_file(String path);
 void close_file(File_Handle file);
 Option<u64> get_file_size(File_Handle file);
-Option<u64> read_file(File_Handle file, Array<u8> dst, u64 num_bytes);
\ No newline at end of file
+Option<u64> read_file(File_Handle file, Array<u8> dst, u64 num_bytes);
+
+// Unlike open_file these don't assert, a missing file or a failed write is up to the caller.
+bool file_exists(String path);
+File_Handle create_file(String path); // Opens for writing, replaces the file if it exists.
+bool write_file(File_Handle file, void const* data, u64 num_bytes);
+bool move_file(String from, String to); // Atomically replaces `to` if it exists.
+bool delete_file(String path);
+bool create_directory(String path);     // Also succeeds if it already exists.
+
+// Identify the calling process and thread, e.g. to give files written concurrently unique names.
+u64 platform_get_process_id();
+u64 platform_get_thread_id();
\ No newline at end of file
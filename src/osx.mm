@@ -11,8 +11,10 @@
 #import <os/log.h>
 
 #include <assert.h>
+#include <errno.h>
 #include <mach-o/dyld.h>
 #include <pthread.h>
+#include <sys/stat.h>
 #include <sys/sysctl.h>
 
 //From: https://developer.apple.com/library/archive/qa/qa1361/_index.html
@@ -952,4 +954,78 @@ Option<u64> read_file(File_Handle file, Array<u8> dst, u64 num_bytes)
 
     option_set(&result, bytes_read);
     return result;
-}
\ No newline at end of file
+}
+
+bool file_exists(String path)
+{
+    struct stat info;
+    return stat(path.buffer, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+File_Handle create_file(String path)
+{
+    FILE* handle = fopen(path.buffer, "wb");
+    if (!handle)
+    {
+        LOG("Failed to create file '%s': %s", path.buffer, strerror(errno));
+    }
+    return File_Handle { handle };
+}
+
+bool write_file(File_Handle file, void const* data, u64 num_bytes)
+{
+    if (!is_file_valid(file))
+    {
+        return false;
+    }
+
+    u64 bytes_written = fwrite(data, 1, num_bytes, file.handle);
+    if (bytes_written != num_bytes || fflush(file.handle) != 0)
+    {
+        LOG("Failed to write file: expected=%llu, written=%llu: %s", num_bytes, bytes_written, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool move_file(String from, String to)
+{
+    if (rename(from.buffer, to.buffer) != 0)
+    {
+        LOG("Failed to move '%s' to '%s': %s", from.buffer, to.buffer, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool delete_file(String path)
+{
+    if (remove(path.buffer) != 0)
+    {
+        LOG("Failed to delete '%s': %s", path.buffer, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool create_directory(String path)
+{
+    if (mkdir(path.buffer, 0755) != 0 && errno != EEXIST)
+    {
+        LOG("Failed to create directory '%s': %s", path.buffer, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+u64 platform_get_process_id()
+{
+    return u64(getpid());
+}
+
+u64 platform_get_thread_id()
+{
+    u64 thread_id = 0;
+    pthread_threadid_np(nullptr, &thread_id);
+    return thread_id;
+}
@@ -0,0 +1,201 @@
+#pragma once
+#include "core.h"
+#include "memory.h"
+
+// Fixed capacity pool of T addressed through 32-bit generational handles.
+// Live objects are kept densely packed in `items` so they can be iterated like an
+// array, freeing moves the last object into the hole. Pointers returned by pool_get
+// are therefore only valid until the next pool_free, hold on to the handle instead.
+//
+// Every slot stores the generation of the object currently living in it. Freeing bumps
+// the generation, which invalidates all outstanding handles to that slot.
+
+constexpr u32 C_POOL_INDEX_BITS = 20;
+constexpr u32 C_POOL_GENERATION_BITS = 32 - C_POOL_INDEX_BITS;
+constexpr u32 C_POOL_INDEX_MASK = (1u << C_POOL_INDEX_BITS) - 1;
+constexpr u32 C_POOL_MAX_GENERATION = (1u << C_POOL_GENERATION_BITS) - 1;
+constexpr s64 C_POOL_MAX_CAPACITY = s64(C_POOL_INDEX_MASK);
+constexpr u32 C_POOL_INVALID_INDEX = ~0u;
+
+template <typename T>
+struct Pool_Handle
+{
+    // Generation 0 is never handed out, so a zeroed handle is always invalid.
+    u32 value = 0;
+
+    u32 index() const { return value & C_POOL_INDEX_MASK; }
+    u32 generation() const { return value >> C_POOL_INDEX_BITS; }
+
+    bool is_valid() const { return value != 0; }
+    operator bool() const { return is_valid(); }
+
+    bool operator==(Pool_Handle other) const { return value == other.value; }
+    bool operator!=(Pool_Handle other) const { return value != other.value; }
+};
+
+struct Pool_Slot
+{
+    // While the slot is in use this is the position of its object in Pool::items.
+    // While the slot is free this links to the next free slot.
+    u32 dense_idx_or_next_free = C_POOL_INVALID_INDEX;
+    u32 generation = 1;
+};
+
+template <typename T>
+struct Pool
+{
+    T* items = nullptr;
+    u32* dense_to_slot = nullptr;
+    Pool_Slot* slots = nullptr;
+    s64 capacity = 0;
+    s64 count = 0;
+    u32 free_head = C_POOL_INVALID_INDEX;
+
+    T* begin() { return items; }
+    T* end() { return items + count; }
+
+    bool is_valid() const { return items && capacity; }
+    operator bool() const { return is_valid(); }
+};
+
+template <typename T>
+Pool<T> pool_create(Arena* arena, s64 capacity)
+{
+    ASSERT_MSG(capacity > 0 && capacity <= C_POOL_MAX_CAPACITY, "Pool capacity %lld is out of range.", capacity);
+
+    Pool<T> pool;
+    pool.items = (T*)arena_push_a(arena, sizeof(T) * capacity, alignof(T));
+    pool.dense_to_slot = (u32*)arena_push_a(arena, sizeof(u32) * capacity, alignof(u32));
+    pool.slots = (Pool_Slot*)arena_push_a(arena, sizeof(Pool_Slot) * capacity, alignof(Pool_Slot));
+    pool.capacity = capacity;
+
+    // Thread all slots onto the free list in order, so the first handles map to the first slots.
+    for (s64 i = 0; i < capacity; ++i)
+    {
+        pool.slots[i].dense_idx_or_next_free = (i + 1 < capacity) ? u32(i + 1) : C_POOL_INVALID_INDEX;
+        pool.slots[i].generation = 1;
+    }
+    pool.free_head = 0;
+
+    return pool;
+}
+
+namespace detail
+{
+    template <typename T>
+    Pool_Slot* pool_resolve(Pool<T>* pool, Pool_Handle<T> handle)
+    {
+        if (!handle.is_valid() || handle.index() >= pool->capacity)
+        {
+            return nullptr;
+        }
+
+        Pool_Slot* slot = &pool->slots[handle.index()];
+        if (slot->generation != handle.generation())
+        {
+            return nullptr;
+        }
+
+        return slot;
+    }
+}
+
+template <typename T>
+Pool_Handle<T> pool_alloc(Pool<T>* pool, bool assert_on_fail = true)
+{
+    if (pool->free_head == C_POOL_INVALID_INDEX)
+    {
+        ASSERT_MSG(!assert_on_fail, "Exceeded pool capacity of %lld objects.", pool->capacity);
+        return {};
+    }
+
+    u32 slot_idx = pool->free_head;
+    Pool_Slot* slot = &pool->slots[slot_idx];
+    pool->free_head = slot->dense_idx_or_next_free;
+
+    u32 dense_idx = u32(pool->count++);
+    slot->dense_idx_or_next_free = dense_idx;
+    pool->dense_to_slot[dense_idx] = slot_idx;
+    pool->items[dense_idx] = T{};
+
+    return Pool_Handle<T>{(slot->generation << C_POOL_INDEX_BITS) | slot_idx};
+}
+
+template <typename T>
+Pool_Handle<T> pool_alloc(Pool<T>* pool, T const& v, bool assert_on_fail = true)
+{
+    Pool_Handle<T> handle = pool_alloc(pool, assert_on_fail);
+    if (handle)
+    {
+        pool->items[pool->slots[handle.index()].dense_idx_or_next_free] = v;
+    }
+    return handle;
+}
+
+template <typename T>
+Pool_Handle<T> try_pool_alloc(Pool<T>* pool)
+{
+    return pool_alloc(pool, false);
+}
+
+template <typename T>
+bool pool_is_alive(Pool<T>* pool, Pool_Handle<T> handle)
+{
+    return detail::pool_resolve(pool, handle) != nullptr;
+}
+
+// Returns nullptr for handles whose object has been freed.
+template <typename T>
+T* try_pool_get(Pool<T>* pool, Pool_Handle<T> handle)
+{
+    Pool_Slot* slot = detail::pool_resolve(pool, handle);
+    return slot ? &pool->items[slot->dense_idx_or_next_free] : nullptr;
+}
+
+template <typename T>
+T* pool_get(Pool<T>* pool, Pool_Handle<T> handle)
+{
+    T* item = try_pool_get(pool, handle);
+    ASSERT_MSG(item, "Used stale or invalid pool handle (index %u, generation %u).", handle.index(), handle.generation());
+    return item;
+}
+
+template <typename T>
+bool pool_free(Pool<T>* pool, Pool_Handle<T> handle)
+{
+    Pool_Slot* slot = detail::pool_resolve(pool, handle);
+    if (!slot)
+    {
+        ASSERT_FAILED_MSG("Tried to free stale or invalid pool handle (index %u, generation %u).", handle.index(), handle.generation());
+        return false;
+    }
+
+    // Keep items dense by moving the last object into the freed position.
+    u32 dense_idx = slot->dense_idx_or_next_free;
+    ASSERT_PARANOID(pool->dense_to_slot[dense_idx] == handle.index());
+    u32 last_idx = u32(pool->count - 1);
+    if (dense_idx != last_idx)
+    {
+        u32 moved_slot_idx = pool->dense_to_slot[last_idx];
+        pool->items[dense_idx] = pool->items[last_idx];
+        pool->dense_to_slot[dense_idx] = moved_slot_idx;
+        pool->slots[moved_slot_idx].dense_idx_or_next_free = dense_idx;
+    }
+    --pool->count;
+
+    // Generation 0 is reserved for invalid handles, so skip it when wrapping around.
+    slot->generation = (slot->generation == C_POOL_MAX_GENERATION) ? 1 : slot->generation + 1;
+    slot->dense_idx_or_next_free = pool->free_head;
+    pool->free_head = u32(handle.index());
+
+    return true;
+}
+
+// Returns the handle of the object at position dense_idx in Pool::items, useful when iterating.
+template <typename T>
+Pool_Handle<T> pool_handle_at(Pool<T>* pool, s64 dense_idx)
+{
+    ASSERT(dense_idx < pool->count);
+    u32 slot_idx = pool->dense_to_slot[dense_idx];
+    return Pool_Handle<T>{(pool->slots[slot_idx].generation << C_POOL_INDEX_BITS) | slot_idx};
+}
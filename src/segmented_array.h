@@ -0,0 +1,140 @@
+#pragma once
+#include "core.h"
+#include "memory.h"
+
+// Growable array that allocates its storage from an Arena in segments of doubling size.
+// Segments are never reallocated, so pointers to elements stay valid for the lifetime
+// of the array. Segment k holds first_segment_size << k elements, which lets us find
+// an element's segment with a single bit scan instead of walking a list.
+//
+// Use this where the final count is only known at runtime (draw lists, asset tables),
+// and seg_array_flatten_into when the data needs to be contiguous (e.g. for upload).
+
+constexpr s64 C_SEG_ARRAY_MAX_SEGMENTS = 32;
+constexpr s64 C_SEG_ARRAY_DEFAULT_FIRST_SEGMENT_SIZE = 64;
+
+template <typename T>
+struct Segmented_Array
+{
+    Arena* arena = nullptr;
+    T* segments[C_SEG_ARRAY_MAX_SEGMENTS] = {};
+    s64 segment_count = 0;
+    s64 count = 0;
+    s64 first_segment_size = 0;
+    u32 first_segment_shift = 0;
+
+    struct Iterator
+    {
+        Segmented_Array const* owner = nullptr;
+        T* item = nullptr;
+        T* segment_end = nullptr;
+        s64 segment = 0;
+        s64 remaining = 0;
+
+        T& operator*() const { return *item; }
+
+        Iterator& operator++()
+        {
+            --remaining;
+            if (++item == segment_end && remaining > 0)
+            {
+                ++segment;
+                item = owner->segments[segment];
+                segment_end = item + (owner->first_segment_size << segment);
+            }
+            return *this;
+        }
+
+        bool operator!=(Iterator const& other) const { return remaining != other.remaining; }
+    };
+
+    Iterator begin() const
+    {
+        T* first = segments[0];
+        return Iterator{this, first, first + first_segment_size, 0, count};
+    }
+
+    Iterator end() const
+    {
+        return Iterator{this, nullptr, nullptr, 0, 0};
+    }
+
+    T& operator[](s64 idx)
+    {
+        ASSERT_DEBUG(idx >= 0 && idx < count);
+
+        // Element idx lives in segment k when (first << k) <= idx + first < (first << (k + 1)).
+        u64 biased = u64(idx + first_segment_size);
+        u32 segment = bit_scan_reverse(biased) - first_segment_shift;
+        return segments[segment][biased - (u64(first_segment_size) << segment)];
+    }
+
+    bool is_valid() const { return arena != nullptr; }
+    operator bool() const { return is_valid(); }
+};
+
+template <typename T>
+Segmented_Array<T> seg_array_create(Arena* arena, s64 first_segment_size = C_SEG_ARRAY_DEFAULT_FIRST_SEGMENT_SIZE)
+{
+    ASSERT_MSG(is_pow2(first_segment_size), "First segment size (%lld) must be a power of two.", first_segment_size);
+
+    Segmented_Array<T> result;
+    result.arena = arena;
+    result.first_segment_size = first_segment_size;
+    result.first_segment_shift = bit_scan_reverse(u64(first_segment_size));
+    return result;
+}
+
+template <typename T>
+T* seg_array_push(Segmented_Array<T>* arr)
+{
+    s64 capacity = (arr->first_segment_size << arr->segment_count) - arr->first_segment_size;
+    if (arr->count == capacity)
+    {
+        if (arr->segment_count == C_SEG_ARRAY_MAX_SEGMENTS)
+        {
+            ASSERT_FAILED_MSG("Exceeded the maximum number of segments in a segmented array.");
+            return nullptr;
+        }
+
+        s64 segment_size = arr->first_segment_size << arr->segment_count;
+        T* segment = (T*)arena_push_a(arr->arena, sizeof(T) * segment_size, alignof(T));
+        if (!segment)
+        {
+            return nullptr;
+        }
+        arr->segments[arr->segment_count++] = segment;
+    }
+
+    return &(*arr)[arr->count++];
+}
+
+template <typename T>
+T* seg_array_push(Segmented_Array<T>* arr, T const& v)
+{
+    T* nv = seg_array_push(arr);
+    if (nv)
+    {
+        *nv = v;
+    }
+    return nv;
+}
+
+// Copies all elements into one contiguous allocation on the given arena.
+template <typename T>
+Array<T> seg_array_flatten_into(Segmented_Array<T> const& arr, Arena* arena)
+{
+    Array<T> result = arena_push_array_no_zero<T>(arena, arr.count);
+    result.count = arr.count;
+
+    s64 copied = 0;
+    for (s64 segment = 0; copied < arr.count; ++segment)
+    {
+        s64 segment_size = arr.first_segment_size << segment;
+        s64 to_copy = (arr.count - copied < segment_size) ? (arr.count - copied) : segment_size;
+        memcpy(result.array + copied, arr.segments[segment], sizeof(T) * to_copy);
+        copied += to_copy;
+    }
+
+    return result;
+}
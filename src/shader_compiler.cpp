@@ -3,10 +3,22 @@
 #include "core.h"
 #include "context.h"
 #include "glslang_c_interface.h"
+#include "hash.h"
+#include "jobs.h"
 #include "memory.h"
 #include "platform.h"
+#include "str.h"
 #include "vk.h"
 
+// Newer glslang builds ship their version next to the C interface header. Older SDKs don't,
+// there the Vulkan header version in the cache key stands in for it, the SDK updates both.
+#if __has_include("../build_info.h")
+#include "../build_info.h"
+constexpr u32 C_GLSLANG_VERSION = GLSLANG_VERSION_MAJOR * 1000000 + GLSLANG_VERSION_MINOR * 1000 + GLSLANG_VERSION_PATCH;
+#else
+constexpr u32 C_GLSLANG_VERSION = 0;
+#endif
+
 // Neither the vulkan SDK nor the latest glslang CI build
 // seem to ship with this for some reason, so we just took
 // it from the glslang repo.
@@ -148,8 +160,10 @@ Array<u8> load_file(String file_path, Arena* arena)
         return {};
     }
 
-    u64 content_size = file_size_result.value + 1; // allocate an extra byte for the null-terminator.
-    Array<u8> shader_data = arena_push_array<u8>(arena, content_size);
+    // Allocate an extra byte for the null-terminator. Aligned so binary files can be read in place.
+    u64 content_size = file_size_result.value + 1;
+    u8* content = (u8*)arena_push_no_zero_a(arena, content_size, alignof(u64)); // Fully overwritten by the read below.
+    Array<u8> shader_data = Array<u8>{content, s64(content_size), 0};
 
     Option<u64> read_result = read_file(file_handle, shader_data, file_size_result.value);
     if (!read_result.has_value)
@@ -201,17 +215,169 @@ glslang_target_client_version_t map_version(u32 val)
     }
 }
 
-VkShaderModule compile_shader(VkDevice vk_device, Shader_Stage::Enum stage, String src_path, Context* ctx)
+// Compiled SPIR-V is cached on disk, one file per shader named after a hash of everything that
+// goes into compiling it. A changed source, define or compiler version just gives a new key,
+// stale files are never read again. Each file starts with a Shader_Cache_Header and anything
+// that doesn't check out is treated as a miss and overwritten with a fresh compile.
+//
+// The glslang options in compile_spirv aren't part of the key, bump C_SHADER_CACHE_FORMAT
+// when changing them or the file layout.
+
+constexpr u32 C_SHADER_CACHE_MAGIC = 0x43565053; // "SPVC"
+constexpr u32 C_SHADER_CACHE_FORMAT = 1;
+constexpr u32 C_SPIRV_MAGIC = 0x07230203;
+
+struct Shader_Cache_Header
 {
-    ARENA_DEFER_CLEAR(ctx->tmp_bump);
+    u32 magic = C_SHADER_CACHE_MAGIC;
+    u32 format = C_SHADER_CACHE_FORMAT;
+    u64 key = 0;
+    u64 spirv_hash = 0;
+    u64 spirv_size = 0; // In bytes, the SPIR-V words follow the header.
+};
 
-    Array<u8> shader_code = load_file(src_path, ctx->tmp_bump);
-    if (!shader_code.is_valid())
+static_assert(sizeof(Shader_Cache_Header) % sizeof(u32) == 0, "The SPIR-V after the header has to stay aligned.");
+
+struct Shader_Compiler
+{
+    char cache_dir[MAX_PATH] = {};
+    bool cache_enabled = false;
+    bool glslang_initialized = false;
+};
+
+static Shader_Compiler shader_compiler;
+
+// Everything besides the source that changes the generated SPIR-V, hashed as raw bytes.
+struct Shader_Cache_Key_Inputs
+{
+    u32 format = C_SHADER_CACHE_FORMAT;
+    u32 stage = 0;
+    u32 vk_version = C_TARGET_VK_VERSION;
+    u32 vk_header_version = VK_HEADER_VERSION_COMPLETE;
+    u32 glslang_version = C_GLSLANG_VERSION;
+};
+
+// The source already contains the defines, see source_with_defines.
+static u64 shader_cache_key(Shader_Stage::Enum stage, String source)
+{
+    Shader_Cache_Key_Inputs inputs;
+    inputs.stage = u32(stage);
+    u64 key = hash_bytes(&inputs, sizeof(inputs));
+    return hash_bytes(source.buffer, source.len, key);
+}
+
+static String shader_cache_path(Arena* arena, u64 key)
+{
+    return string_format(arena, "%s/%016llx.spv", shader_compiler.cache_dir, key);
+}
+
+// Returns the SPIR-V of a valid cache entry, pointing into the loaded file, or an empty array on a miss.
+static Array<u32> shader_cache_load(String path, u64 key, Arena* arena)
+{
+    if (!file_exists(path))
     {
-        LOG("Failed to load shader from %s", src_path.buffer);
-        return VK_NULL_HANDLE;
+        return {};
+    }
+
+    Array<u8> file = load_file(path, arena);
+    if (!file.is_valid())
+    {
+        return {};
+    }
+
+    u64 file_size = u64(file.size - 1); // load_file adds a null-terminator.
+    Shader_Cache_Header header;
+    if (file_size < sizeof(header))
+    {
+        LOG("Shader cache file %s is truncated, recompiling.", path.buffer);
+        return {};
+    }
+    memcpy(&header, file.array, sizeof(header));
+
+    u8 const* spirv = file.array + sizeof(header);
+    bool valid = header.magic == C_SHADER_CACHE_MAGIC
+        && header.format == C_SHADER_CACHE_FORMAT
+        && header.key == key
+        && header.spirv_size == file_size - sizeof(header)
+        && header.spirv_size >= sizeof(u32)
+        && header.spirv_size % sizeof(u32) == 0
+        && hash_bytes(spirv, header.spirv_size) == header.spirv_hash
+        && *(u32 const*)spirv == C_SPIRV_MAGIC;
+    if (!valid)
+    {
+        LOG("Shader cache file %s is invalid or corrupted, recompiling.", path.buffer);
+        return {};
+    }
+
+    s64 num_words = s64(header.spirv_size / sizeof(u32));
+    return Array<u32>{(u32*)spirv, num_words, num_words};
+}
+
+// Writes to a temporary file first and moves it into place, so a crash or another instance
+// reading at the same time never sees a partial entry. The temporary file is unique per process
+// and thread, two writers of the same entry (other instances, or identical requests on different
+// workers) each move a complete file into place and the last one wins.
+static void shader_cache_store(String path, u64 key, Array<u32> spirv, Arena* arena)
+{
+    Shader_Cache_Header header;
+    header.key = key;
+    header.spirv_size = u64(spirv.count) * sizeof(u32);
+    header.spirv_hash = hash_bytes(spirv.array, header.spirv_size);
+
+    String tmp_path = string_format(arena, "%s.%llu.%llu.tmp", path.buffer, platform_get_process_id(), platform_get_thread_id());
+    File_Handle file = create_file(tmp_path);
+    if (!is_file_valid(file))
+    {
+        return;
+    }
+
+    bool written = write_file(file, &header, sizeof(header)) && write_file(file, spirv.array, header.spirv_size);
+    close_file(file);
+
+    if (!written || !move_file(tmp_path, path))
+    {
+        LOG("Failed to write shader cache file %s.", path.buffer);
+        delete_file(tmp_path);
+    }
+}
+
+// Defines go right after the #version line, which has to come first. The #line directive
+// keeps the line numbers in compiler errors matching the file.
+static String source_with_defines(Arena* arena, String source, Slice<String> defines)
+{
+    if (defines.count == 0)
+    {
+        return source;
+    }
+
+    u32 insert_at = 0;
+    u32 version_line = 0;
+    if (char const* version = strstr(source.buffer, "#version"))
+    {
+        char const* line_end = strchr(version, '\n');
+        insert_at = line_end ? u32(line_end + 1 - source.buffer) : source.len;
+        for (u32 i = 0; i < insert_at; ++i)
+        {
+            version_line += (source.buffer[i] == '\n') ? 1 : 0;
+        }
     }
 
+    String_Builder sb = string_builder_create(arena, source.len + 256);
+    string_builder_append(&sb, String{source.buffer, insert_at});
+    for (String define : defines)
+    {
+        string_builder_appendf(&sb, "#define %.*s\n", int(define.len), define.buffer);
+    }
+    string_builder_appendf(&sb, "#line %u\n", version_line + 1);
+    string_builder_append(&sb, String{source.buffer + insert_at, source.len - insert_at});
+    return string_builder_to_string(&sb);
+}
+
+// Runs glslang, compile_shaders initializes it once the first shader misses the cache.
+static Array<u32> compile_spirv(Shader_Stage::Enum stage, String src_path, String source, Arena* arena)
+{
+    ASSERT_DEBUG_MSG(shader_compiler.glslang_initialized, "glslang has to be initialized before compiling %s", src_path.buffer);
+
     glslang_input_t input = {};
     input.language = GLSLANG_SOURCE_GLSL;
     input.stage = map_stage(stage);
@@ -225,7 +391,7 @@ VkShaderModule compile_shader(VkDevice vk_device, Shader_Stage::Enum stage, Stri
     input.forward_compatible = false;
     input.messages = GLSLANG_MSG_DEFAULT_BIT;
     input.resource = (const glslang_resource_t*)&glslang::DefaultTBuiltInResource;
-    input.code = reinterpret_cast<char const*>(shader_code.array);
+    input.code = source.buffer;
 
     glslang_shader_t* shader = glslang_shader_create(&input);
     DEFER { glslang_shader_delete(shader); };
@@ -240,16 +406,16 @@ VkShaderModule compile_shader(VkDevice vk_device, Shader_Stage::Enum stage, Stri
     if (!glslang_shader_preprocess(shader, &input))
     {
         log_shader_info(shader);
-        ASSERT_FAILED_MSG("Failed pre-processing shader %s", src_path);
-        return VK_NULL_HANDLE;
+        ASSERT_FAILED_MSG("Failed pre-processing shader %s", src_path.buffer);
+        return {};
     }
 
     if (!glslang_shader_parse(shader, &input))
     {
         LOG("%s", input.code);
         log_shader_info(shader);
-        ASSERT_FAILED_MSG("Failed parsing shader %s", src_path);
-        return VK_NULL_HANDLE;
+        ASSERT_FAILED_MSG("Failed parsing shader %s", src_path.buffer);
+        return {};
     }
 
     glslang_program_t* program = glslang_program_create();
@@ -260,13 +426,13 @@ VkShaderModule compile_shader(VkDevice vk_device, Shader_Stage::Enum stage, Stri
     if (!glslang_program_link(program, GLSLANG_MSG_SPV_RULES_BIT | GLSLANG_MSG_VULKAN_RULES_BIT))
     {
         log_shader_info(shader);
-        ASSERT_FAILED_MSG("Failed linking shader %s", src_path);
-        return VK_NULL_HANDLE;
+        ASSERT_FAILED_MSG("Failed linking shader %s", src_path.buffer);
+        return {};
     }
 
     glslang_program_SPIRV_generate(program, input.stage);
     size_t byte_code_size = glslang_program_SPIRV_get_size(program);
-    Array<u32> byte_code = arena_push_array<u32>(ctx->bump, byte_code_size);
+    Array<u32> byte_code = arena_push_array_with_count<u32>(arena, byte_code_size, byte_code_size);
 
     glslang_program_SPIRV_get(program, byte_code.array);
 
@@ -278,8 +444,57 @@ VkShaderModule compile_shader(VkDevice vk_device, Shader_Stage::Enum stage, Stri
         }
     }
 
+    return byte_code;
+}
+
+// Loads, looks up and if needed compiles one shader, everything temporary goes to the calling
+// thread's scratch arenas. Without allow_compile a cache miss only sets *missed.
+static VkShaderModule compile_request(VkDevice vk_device, Shader_Compile_Request const& request, bool allow_compile, bool* missed)
+{
+    Scratch scratch = scratch_begin();
+    SCRATCH_DEFER_END(scratch);
+
+    Array<u8> shader_code = load_file(request.src_path, scratch.arena);
+    if (!shader_code.is_valid())
+    {
+        LOG("Failed to load shader from %s", request.src_path.buffer);
+        return VK_NULL_HANDLE;
+    }
+
+    String source = String{(char*)shader_code.array, u32(shader_code.size - 1)};
+    source = source_with_defines(scratch.arena, source, request.defines);
+
+    u64 key = shader_cache_key(request.stage, source);
+    String cache_path = {};
+    Array<u32> byte_code = {};
+    if (shader_compiler.cache_enabled)
+    {
+        cache_path = shader_cache_path(scratch.arena, key);
+        byte_code = shader_cache_load(cache_path, key, scratch.arena);
+    }
+
+    if (!byte_code.is_valid())
+    {
+        if (!allow_compile)
+        {
+            *missed = true;
+            return VK_NULL_HANDLE;
+        }
+
+        byte_code = compile_spirv(request.stage, request.src_path, source, scratch.arena);
+        if (!byte_code.is_valid())
+        {
+            return VK_NULL_HANDLE;
+        }
+
+        if (shader_compiler.cache_enabled)
+        {
+            shader_cache_store(cache_path, key, byte_code, scratch.arena);
+        }
+    }
+
     VkShaderModuleCreateInfo create_info = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
-    create_info.codeSize = byte_code_size * sizeof(u32); // size in bytes
+    create_info.codeSize = byte_code.count * sizeof(u32); // size in bytes
     create_info.pCode = byte_code.array;
 
     VkShaderModule vk_shader = VK_NULL_HANDLE;
@@ -288,12 +503,117 @@ VkShaderModule compile_shader(VkDevice vk_device, Shader_Stage::Enum stage, Stri
     return vk_shader;
 }
 
-void shader_compiler_init()
+struct Shader_Compile_Job
+{
+    VkDevice vk_device = VK_NULL_HANDLE;
+    Shader_Compile_Request const* requests = nullptr;
+    VkShaderModule* out_modules = nullptr;
+    bool* missed = nullptr;
+    bool allow_compile = false;
+};
+
+static void compile_shaders_range(void* user, s64 begin, s64 end)
 {
-    glslang_initialize_process();
+    Shader_Compile_Job const* job = (Shader_Compile_Job const*)user;
+    for (s64 i = begin; i < end; ++i)
+    {
+        // The second pass only revisits the cache misses of the first.
+        if (job->allow_compile && !job->missed[i])
+        {
+            continue;
+        }
+        job->out_modules[i] = compile_request(job->vk_device, job->requests[i], job->allow_compile, &job->missed[i]);
+    }
+}
+
+bool compile_shaders(VkDevice vk_device, Slice<Shader_Compile_Request> requests, VkShaderModule* out_modules, Context* ctx)
+{
+    Scratch scratch = scratch_begin();
+    SCRATCH_DEFER_END(scratch);
+
+    Shader_Compile_Job job;
+    job.vk_device = vk_device;
+    job.requests = requests.array;
+    job.out_modules = out_modules;
+    job.missed = arena_push_array<bool>(scratch.arena, requests.count).array;
+
+    // First pass: cache hits only, so glslang doesn't have to start up when everything hits.
+    // Without a cache everything misses, and the pass would only load and hash every source twice.
+    if (shader_compiler.cache_enabled)
+    {
+        job_parallel_for(ctx->jobs, requests.count, C_SHADER_COMPILE_JOB_SIZE, compile_shaders_range, &job);
+    }
+    else
+    {
+        for (s64 i = 0; i < requests.count; ++i)
+        {
+            job.missed[i] = true;
+        }
+    }
+
+    bool any_missed = false;
+    for (s64 i = 0; i < requests.count; ++i)
+    {
+        any_missed |= job.missed[i];
+    }
+
+    if (any_missed)
+    {
+        // glslang's process wide state is set up once here. Everything else it allocates while
+        // compiling lives in pools per thread, so the workers don't share anything.
+        if (!shader_compiler.glslang_initialized)
+        {
+            glslang_initialize_process();
+            shader_compiler.glslang_initialized = true;
+        }
+
+        job.allow_compile = true;
+        job_parallel_for(ctx->jobs, requests.count, C_SHADER_COMPILE_JOB_SIZE, compile_shaders_range, &job);
+    }
+
+    bool all_created = true;
+    for (s64 i = 0; i < requests.count; ++i)
+    {
+        all_created &= out_modules[i] != VK_NULL_HANDLE;
+    }
+    return all_created;
+}
+
+VkShaderModule compile_shader(VkDevice vk_device, Shader_Stage::Enum stage, String src_path, Context* ctx, Slice<String> defines)
+{
+    Shader_Compile_Request const requests[] = { Shader_Compile_Request{stage, src_path, defines} };
+    VkShaderModule vk_shader = VK_NULL_HANDLE;
+    compile_shaders(vk_device, Slice<Shader_Compile_Request>(requests), &vk_shader, ctx);
+    return vk_shader;
+}
+
+void shader_compiler_init(String cache_dir)
+{
+    shader_compiler = Shader_Compiler{};
+    if (cache_dir.len == 0)
+    {
+        return;
+    }
+
+    if (cache_dir.len >= MAX_PATH)
+    {
+        ASSERT_FAILED_MSG("Shader cache path is too long: %s", cache_dir.buffer);
+        return;
+    }
+
+    memcpy(shader_compiler.cache_dir, cache_dir.buffer, cache_dir.len);
+    shader_compiler.cache_enabled = create_directory(cache_dir);
+    if (!shader_compiler.cache_enabled)
+    {
+        LOG("Shader cache disabled, every shader is compiled from source.");
+    }
 }
 
 void shader_compiler_shutdown()
 {
-    glslang_finalize_process();
+    if (shader_compiler.glslang_initialized)
+    {
+        glslang_finalize_process();
+        shader_compiler.glslang_initialized = false;
+    }
 }
\ No newline at end of file
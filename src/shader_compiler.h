@@ -1,5 +1,6 @@
 #pragma once
 #include "core.h"
+#include "memory.h"
 
 struct VkDevice_T;
 struct VkShaderModule_T;
@@ -16,7 +17,29 @@ struct Shader_Stage
 	};
 };
 
-VkShaderModule_T* compile_shader(VkDevice_T* vk_device, Shader_Stage::Enum stage, String src_path, Context* ctx);
+// Shaders are big enough units of work to hand them to the workers one at a time.
+constexpr s64 C_SHADER_COMPILE_JOB_SIZE = 1;
 
-void shader_compiler_init();
+struct Shader_Compile_Request
+{
+    Shader_Stage::Enum stage = Shader_Stage::vertex;
+    String src_path;
+    Slice<String> defines; // Each is "NAME" or "NAME VALUE".
+};
+
+// Compiles all requests across ctx->jobs and writes the module for requests[i] to out_modules[i],
+// VK_NULL_HANDLE if it failed. Returns true if every module was created. Each thread works in its
+// own scratch arenas and glslang objects, nothing outlives the call except the modules.
+bool compile_shaders(VkDevice_T* vk_device, Slice<Shader_Compile_Request> requests, VkShaderModule_T** out_modules, Context* ctx);
+
+// Reads the whole file into the arena and appends a null-terminator. The buffer is aligned to
+// 8 bytes, so binary files can be read in place. Returns an invalid Array if the read failed.
+Array<u8> load_file(String file_path, Arena* arena);
+
+// compile_shaders for a single shader.
+VkShaderModule_T* compile_shader(VkDevice_T* vk_device, Shader_Stage::Enum stage, String src_path, Context* ctx, Slice<String> defines = {});
+
+// Compiled shaders are cached in cache_dir, which is created if it doesn't exist. An empty
+// cache_dir compiles everything from source. glslang is only started once a shader misses the cache.
+void shader_compiler_init(String cache_dir);
 void shader_compiler_shutdown();
\ No newline at end of file
@@ -1,6 +1,9 @@
 #version 450
 
+// snorm16 relative to the mesh bounds. Vertex fetch maps them to [-1, 1], mapping that back
+// into model space is folded into mvp on the CPU (mesh_dequantize_matrix in mesh.h).
 layout(location = 0) in vec3 vpos;
+// RGBA8 unorm.
 layout(location = 1) in vec3 vcol;
 
 layout(location = 0) out vec3 fcol;
@@ -10,8 +13,19 @@ layout(push_constant) uniform constants
 	mat4 mvp;
 } uniforms;
 
+// Decodes octahedral snorm16 normals, matches oct_decode in mesh.h.
+vec3 oct_decode(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+
 void main()
 {
 	fcol = vcol;
 	gl_Position = uniforms.mvp * vec4(vpos, 1.0);
-}
\ No newline at end of file
+}
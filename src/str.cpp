@@ -0,0 +1,184 @@
+#include "str.h"
+
+String string_from_cstr(char const* cstr)
+{
+    return String{(char*)cstr, u32(strlen(cstr))};
+}
+
+bool strings_equal(String lhs, String rhs)
+{
+    return lhs.len == rhs.len && memcmp(lhs.buffer, rhs.buffer, lhs.len) == 0;
+}
+
+String string_copy(Arena* arena, String s)
+{
+    char* buffer = (char*)arena_push_no_zero(arena, s.len + 1);
+    memcpy(buffer, s.buffer, s.len);
+    buffer[s.len] = '\0';
+    return String{buffer, s.len};
+}
+
+String_Table string_table_create(Arena* arena, s64 expected_count)
+{
+    String_Table table;
+    table.arena = arena;
+    table.ids = hash_map_create<String, u32>(nullptr, expected_count);
+    table.strings = seg_array_create<String>(arena);
+    return table;
+}
+
+void string_table_destroy(String_Table* table)
+{
+    hash_map_destroy(&table->ids);
+}
+
+String_Id string_intern(String_Table* table, String s)
+{
+    bool was_added = false;
+    Hash_Map_Slot<String, u32>* slot = hash_map_find_or_add_slot(&table->ids, s, &was_added);
+    if (was_added)
+    {
+        // The slot still references the caller's buffer, point it at our own copy instead.
+        String* stored = seg_array_push(&table->strings, string_copy(table->arena, s));
+        slot->key = *stored;
+        slot->value = u32(table->strings.count);
+    }
+    return String_Id{slot->value};
+}
+
+String_Id string_intern(String_Table* table, char const* cstr)
+{
+    return string_intern(table, string_from_cstr(cstr));
+}
+
+String_Id string_table_find(String_Table* table, String s)
+{
+    u32* id = hash_map_find(&table->ids, s);
+    return id ? String_Id{*id} : String_Id{};
+}
+
+String string_table_get(String_Table* table, String_Id id)
+{
+    ASSERT_MSG(id.is_valid() && id.value <= table->strings.count, "Invalid string id %u", id.value);
+    return table->strings[id.value - 1];
+}
+
+String_Builder string_builder_create(Arena* arena, u32 initial_capacity)
+{
+    String_Builder sb;
+    sb.arena = arena;
+    sb.buffer = (char*)arena_push_no_zero(arena, initial_capacity + 1);
+    sb.capacity = initial_capacity;
+    sb.buffer[0] = '\0';
+    return sb;
+}
+
+static void string_builder_reserve(String_Builder* sb, u32 additional)
+{
+    u32 required = sb->len + additional;
+    if (required <= sb->capacity)
+    {
+        return;
+    }
+
+    u32 new_capacity = sb->capacity ? sb->capacity : 16;
+    while (new_capacity < required)
+    {
+        new_capacity *= 2;
+    }
+
+    u8* arena_top = (u8*)sb->arena->buffer + sb->arena->bytes_allocated;
+    bool is_at_top = (u8*)sb->buffer + sb->capacity + 1 == arena_top;
+    if (is_at_top)
+    {
+        arena_push_no_zero(sb->arena, new_capacity - sb->capacity);
+    }
+    else
+    {
+        char* new_buffer = (char*)arena_push_no_zero(sb->arena, new_capacity + 1);
+        memcpy(new_buffer, sb->buffer, sb->len + 1);
+        sb->buffer = new_buffer;
+    }
+    sb->capacity = new_capacity;
+}
+
+void string_builder_append(String_Builder* sb, String s)
+{
+    string_builder_reserve(sb, s.len);
+    memcpy(sb->buffer + sb->len, s.buffer, s.len);
+    sb->len += s.len;
+    sb->buffer[sb->len] = '\0';
+}
+
+void string_builder_append(String_Builder* sb, char const* cstr)
+{
+    string_builder_append(sb, string_from_cstr(cstr));
+}
+
+static void string_builder_vappendf(String_Builder* sb, char const* fmt, va_list args)
+{
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int required = vsnprintf(nullptr, 0, fmt, args);
+    if (required > 0)
+    {
+        string_builder_reserve(sb, u32(required));
+        vsnprintf(sb->buffer + sb->len, required + 1, fmt, args_copy);
+        sb->len += u32(required);
+    }
+    va_end(args_copy);
+}
+
+void string_builder_appendf(String_Builder* sb, char const* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    string_builder_vappendf(sb, fmt, args);
+    va_end(args);
+}
+
+static bool is_path_separator(char c)
+{
+    return c == '/' || c == '\\';
+}
+
+void string_builder_append_path(String_Builder* sb, String component)
+{
+    while (component.len && is_path_separator(component.buffer[0]))
+    {
+        ++component.buffer;
+        --component.len;
+    }
+
+    if (sb->len && !is_path_separator(sb->buffer[sb->len - 1]))
+    {
+        string_builder_append(sb, STRING_LIT("/"));
+    }
+
+    string_builder_append(sb, component);
+}
+
+String string_builder_to_string(String_Builder const* sb)
+{
+    return String{sb->buffer, sb->len};
+}
+
+String string_format(Arena* arena, char const* fmt, ...)
+{
+    String_Builder sb = string_builder_create(arena, 0);
+
+    va_list args;
+    va_start(args, fmt);
+    string_builder_vappendf(&sb, fmt, args);
+    va_end(args);
+
+    return string_builder_to_string(&sb);
+}
+
+String path_join(Arena* arena, String lhs, String rhs)
+{
+    String_Builder sb = string_builder_create(arena, lhs.len + rhs.len + 1);
+    string_builder_append(&sb, lhs);
+    string_builder_append_path(&sb, rhs);
+    return string_builder_to_string(&sb);
+}
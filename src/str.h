@@ -0,0 +1,69 @@
+#pragma once
+#include "core.h"
+#include "hash_map.h"
+#include "memory.h"
+#include "segmented_array.h"
+
+#define STRING_LIT(s) String{(char*)(s), u32(sizeof(s) - 1)}
+
+String string_from_cstr(char const* cstr);
+bool strings_equal(String lhs, String rhs);
+
+// Copies s into the arena and null-terminates the copy.
+String string_copy(Arena* arena, String s);
+
+// Interns strings into compact ids, so equality becomes an integer compare and the ids
+// can be used as cheap keys for assets, shaders or pipelines. Each unique string is hashed
+// and copied into the table's arena once, after which its id and contents stay valid for
+// the lifetime of the arena.
+
+struct String_Id
+{
+    u32 value = 0; // 0 is never handed out and means "no string".
+
+    bool is_valid() const { return value != 0; }
+    bool operator==(String_Id other) const { return value == other.value; }
+    bool operator!=(String_Id other) const { return value != other.value; }
+};
+
+struct String_Table
+{
+    Arena* arena = nullptr;
+    Hash_Map<String, u32> ids;        // Heap backed, so growing it doesn't waste arena space.
+    Segmented_Array<String> strings;  // strings[id - 1], keys in `ids` point at these copies.
+};
+
+String_Table string_table_create(Arena* arena, s64 expected_count = 0);
+void string_table_destroy(String_Table* table);
+
+String_Id string_intern(String_Table* table, String s);
+String_Id string_intern(String_Table* table, char const* cstr);
+
+// Returns an invalid id if the string was never interned.
+String_Id string_table_find(String_Table* table, String s);
+String string_table_get(String_Table* table, String_Id id);
+
+// Builds a string in place at the top of an arena. As long as nothing else is pushed onto the
+// arena while building, appends grow the string without copying. If something else was pushed,
+// the string is moved to the new top of the arena first. The result is always null-terminated.
+
+struct String_Builder
+{
+    Arena* arena = nullptr;
+    char* buffer = nullptr;
+    u32 len = 0;
+    u32 capacity = 0; // Excluding the null-terminator.
+};
+
+String_Builder string_builder_create(Arena* arena, u32 initial_capacity = 256);
+void string_builder_append(String_Builder* sb, String s);
+void string_builder_append(String_Builder* sb, char const* cstr);
+void string_builder_appendf(String_Builder* sb, char const* fmt, ...);
+
+// Appends a path component, inserting or collapsing the separator between it and what came before.
+void string_builder_append_path(String_Builder* sb, String component);
+
+String string_builder_to_string(String_Builder const* sb);
+
+String string_format(Arena* arena, char const* fmt, ...);
+String path_join(Arena* arena, String lhs, String rhs);
@@ -282,6 +282,80 @@ Option<u64> read_file(File_Handle file, Array<u8>* buffer, u32 num_bytes)
     return result;
 }
 
+bool file_exists(String path)
+{
+    DWORD attributes = GetFileAttributesA(path.buffer);
+    return attributes != INVALID_FILE_ATTRIBUTES && !(attributes & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+File_Handle create_file(String path)
+{
+    File_Handle result;
+    result.handle = CreateFileA(path.buffer, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if (!is_file_valid(result))
+    {
+        LOG("Failed to create file %s", path.buffer);
+    }
+    result.path = alloc_string(path.buffer);
+    return result;
+}
+
+bool write_file(File_Handle file, void const* data, u64 num_bytes)
+{
+    if (!is_file_valid(file))
+    {
+        return false;
+    }
+
+    DWORD num_bytes_written = 0;
+    if (!WriteFile(file.handle, data, DWORD(num_bytes), &num_bytes_written, nullptr) || num_bytes_written != num_bytes)
+    {
+        LOG("Failed to write data to file %s", file.path.buffer);
+        return false;
+    }
+    return true;
+}
+
+bool move_file(String from, String to)
+{
+    if (!MoveFileExA(from.buffer, to.buffer, MOVEFILE_REPLACE_EXISTING))
+    {
+        LOG("Failed to move %s to %s", from.buffer, to.buffer);
+        return false;
+    }
+    return true;
+}
+
+bool delete_file(String path)
+{
+    if (!DeleteFileA(path.buffer))
+    {
+        LOG("Failed to delete %s", path.buffer);
+        return false;
+    }
+    return true;
+}
+
+bool create_directory(String path)
+{
+    if (!CreateDirectoryA(path.buffer, nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        LOG("Failed to create directory %s", path.buffer);
+        return false;
+    }
+    return true;
+}
+
+u64 platform_get_process_id()
+{
+    return u64(GetCurrentProcessId());
+}
+
+u64 platform_get_thread_id()
+{
+    return u64(GetCurrentThreadId());
+}
+
 bool platform_is_debugger_present()
 {
     return IsDebuggerPresent();